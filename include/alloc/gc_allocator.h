@@ -0,0 +1,64 @@
+#ifndef _GC_ALLOCATOR_H_
+#define _GC_ALLOCATOR_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/* -------------------------------------------------------------------------- */
+
+/* GCAllocator is a pluggable allocator interface. Containers(GCArray,
+ * GCVector, GCString) and GCEvent can be created with a GCAllocator, in which
+ * case every allocation they make - the container itself included - goes
+ * through it. This allows, for example, building per-request data structures
+ * inside a GCArena(see gc_arena_allocator()) and releasing all of them with a
+ * single gc_arena_rewind().
+ *
+ * Containers keep a copy of the GCAllocator they were created with. The
+ * 'context' must outlive the containers. */
+
+struct GCAllocator
+{
+    /* Allocates 'size' bytes. Returns NULL on failure. */
+    void* (*alloc)(size_t size, void* context);
+
+    /* Resizes the allocation 'ptr' of 'old_size' bytes to 'new_size' bytes,
+     * preserving its content(up to the smaller of the two sizes). Returns the
+     * (possibly moved) allocation or NULL on failure, in which case 'ptr' is
+     * left untouched. */
+    void* (*realloc)(void* ptr, size_t old_size, size_t new_size,
+            void* context);
+
+    /* Frees the allocation 'ptr' of 'size' bytes. May be a no-op. */
+    void (*free)(void* ptr, size_t size, void* context);
+
+    void* context;
+};
+
+/* -------------------------------------------------------------------------- */
+
+/* Returns the default allocator, based on malloc(), realloc() and free(). */
+
+struct GCAllocator gc_allocator_default(void);
+
+/* ------------------------------------------------------ */
+
+/* Returns true if 'allocator' is(a copy of) the default allocator. */
+
+bool gc_allocator_is_default(const struct GCAllocator* allocator);
+
+/* -------------------------------------------------------------------------- */
+
+/* Convenience macros - 'allocator' is a pointer to a struct GCAllocator. */
+
+#define gc_allocator_alloc(allocator, size)                                    \
+    (allocator)->alloc((size), (allocator)->context)
+
+#define gc_allocator_realloc(allocator, ptr, old_size, new_size)               \
+    (allocator)->realloc((ptr), (old_size), (new_size), (allocator)->context)
+
+#define gc_allocator_free(allocator, ptr, size)                                \
+    (allocator)->free((ptr), (size), (allocator)->context)
+
+/* -------------------------------------------------------------------------- */
+
+#endif // _GC_ALLOCATOR_H_
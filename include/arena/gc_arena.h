@@ -2,7 +2,9 @@
 #define _GC_ARENA_H_
 
 #include "gc_shared.h"
+#include "alloc/gc_allocator.h"
 #include <stdlib.h>
+#include <stdint.h>
 
 /* -------------------------------------------------------------------------- */
 
@@ -15,27 +17,124 @@
  * re-populate the once-used memory pools.
  *
  * This arena may perform poorly if 'region_cap' is too small relative to the
- * typical allocation size.
+ * typical allocation size. Allocations larger than 'region_cap' are served
+ * from dedicated "large" regions, kept on a side list. A large region holds a
+ * single allocation. After a rewind, large regions are reused by large
+ * allocations that fit inside them; gc_arena_reset() frees them.
  *
  * It is important to note that each GCArena object has its own lock,
  * assuring optimal performance in a multi-threaded environment. Thread-safety
- * is achieved using pthreads. */
+ * is achieved using pthreads.
+ *
+ * When many threads allocate from the same arena, the arena can be created
+ * with GC_ARENA_THREAD_CACHE. In this mode, each thread carves a private chunk
+ * out of the active region (under the lock) and serves its allocations from
+ * that chunk without locking, until the chunk is exhausted. Alternatively,
+ * with GC_ARENA_ATOMIC, the active region itself is bumped atomically. */
 
 typedef struct GCArena* GCArena;
 
 /* -------------------------------------------------------------------------- */
 
+/* Flags for struct GCArenaOptions. */
+
+/* Each thread allocates from its own chunk, carved out of the active region.
+ * The lock is only taken when a thread's chunk runs out. Unused space at the
+ * end of an exhausted chunk is not reused until the arena is rewound. */
+#define GC_ARENA_THREAD_CACHE (1 << 0)
+
+/* Space in the active region is reserved with an atomic compare-and-swap,
+ * so concurrent allocations from the active region never block. The lock is
+ * only taken to move on to the next region (pushing back a new region or
+ * advancing the rewind iterator). Can be combined with GC_ARENA_THREAD_CACHE,
+ * in which case threads take their chunks with a CAS as well. */
+#define GC_ARENA_ATOMIC (1 << 1)
+
+/* Memory pools are mapped directly with mmap() instead of being allocated
+ * with malloc(). Region capacities are rounded up to the page size. */
+#define GC_ARENA_MMAP (1 << 2)
+
+/* Implies GC_ARENA_MMAP. Memory pools are hinted with MADV_HUGEPAGE, so the
+ * kernel may back them with transparent huge pages(fewer TLB misses). */
+#define GC_ARENA_HUGEPAGES (1 << 3)
+
+/* Implies GC_ARENA_MMAP. Memory pools are mapped with MAP_POPULATE - they are
+ * prefaulted when the region is created, so the first pass over a region does
+ * not take page faults. */
+#define GC_ARENA_POPULATE (1 << 4)
+
+/* For GC_ARENA_MMAP arenas only. gc_arena_rewind() returns the physical memory
+ * of cold regions(regions not used at all since the previous rewind) to the
+ * system with MADV_DONTNEED. The address space is kept - the regions are
+ * still part of the arena and fault their pages back in when reused. */
+#define GC_ARENA_TRIM_ON_REWIND (1 << 5)
+
+/* The arena is only ever used by one thread at a time, so its lock is never
+ * taken. Cannot be combined with GC_ARENA_THREAD_CACHE or GC_ARENA_ATOMIC. */
+#define GC_ARENA_SINGLE_THREAD (1 << 6)
+
+/* Region growth policies for struct GCArenaOptions. */
+
+/* Every region holds 'region_cap' bytes. */
+#define GC_ARENA_GROWTH_FIXED 0
+
+/* Each new region is 'growth_factor' times bigger than the previous one, up
+ * to 'max_region_cap' bytes. */
+#define GC_ARENA_GROWTH_GEOMETRIC 1
+
+/* Regions grow like with GC_ARENA_GROWTH_GEOMETRIC. Additionally, at the end
+ * of each cycle(gc_arena_rewind()/gc_arena_reset()), if the cycle needed more
+ * than one region, the regions are replaced by a single region sized to the
+ * cycle's high-water mark(if that fits inside 'max_region_cap' bytes). This
+ * way, a long-lived arena converges on a single region that fits a whole
+ * cycle. */
+#define GC_ARENA_GROWTH_ADAPTIVE 2
+
+/* ------------------------------------------------------ */
+
+/* Options used to create a GCArena with gc_arena_create_(). A zero-initialized
+ * struct describes the default arena (the one created by gc_arena_create()). */
+
+struct GCArenaOptions
+{
+    /* Bitwise OR of GC_ARENA_* flags. */
+    int flags;
+
+    /* GC_ARENA_THREAD_CACHE only - size of the chunk each thread carves out
+     * of the active region. Allocations larger than this bypass the thread
+     * cache. If 0 or greater than 'region_cap', 'region_cap' / 8 is used
+     * (at least 1 byte). */
+    size_t thread_cache_cap;
+
+    /* One of GC_ARENA_GROWTH_*. */
+    int growth_policy;
+
+    /* GC_ARENA_GROWTH_GEOMETRIC/ADAPTIVE only - if less than or equal to 1.0,
+     * 2.0 is used. */
+    double growth_factor;
+
+    /* GC_ARENA_GROWTH_GEOMETRIC/ADAPTIVE only - regions never grow beyond
+     * this many bytes. Allocations that do not fit inside a region this big
+     * are served from large regions. If less than 'region_cap',
+     * 64 * 'region_cap' is used. */
+    size_t max_region_cap;
+};
+
+/* -------------------------------------------------------------------------- */
+
 /* Dynamically allocates memory for 'struct GCArena' and initializes it. 
  * Dynamically allocates memory for the first memory region, initializes it
  * (which also means that it dynamically allocates memory for its memory pool)
  * and pushes it back to the region list.
  *
  * Each region inside the arena will be capable of holding at most
- * 'region_cap' bytes of data.
+ * 'region_cap' bytes of data (unless a growth policy other than
+ * GC_ARENA_GROWTH_FIXED is used). Larger allocations get a large region of
+ * their own.
  *
  * STATUS CODES: 
  *   1. GC_SUCCESS - function call was successful;
- *   3. GC_ERR_INVALID_ARG - if 'region_cap' is 0; 
+ *   3. GC_ERR_INVALID_ARG - if 'region_cap' is 0 or the options are invalid; 
  *   3. GC_ERR_ALLOC_FAIL - if malloc() fails.
  *
  * RETURN VALUE:
@@ -44,6 +143,16 @@ typedef struct GCArena* GCArena;
 
 GCArena gc_arena_create(size_t region_cap, gc_status* out_status);
 
+/* ------------------------------------------------------ */
+
+/* Creates a GCArena configured by 'options'. gc_arena_create() is equivalent
+ * to calling this function with a zero-initialized struct GCArenaOptions.
+ *
+ * For RETURN VALUE and STATUS CODES, see gc_arena_create(). */
+
+GCArena gc_arena_create_(size_t region_cap, struct GCArenaOptions options,
+        gc_status* out_status);
+
 /* -------------------------------------------------------------------------- */
 
 /* Destroys the arena. This will destroy every region inside the region list.
@@ -57,7 +166,8 @@ void gc_arena_destroy(GCArena arena, gc_status* out_status);
 
 /* This function allocates memory within the arena. It finds the currently active
  * region in the list and attempts to allocate the requested memory size within
- * its internal memory pool. 'Currently active region' refers to:
+ * its internal memory pool. The returned memory is aligned to
+ * _Alignof(max_align_t). 'Currently active region' refers to:
  *
  * 1) If 'rewind mode' is off, the tail of the region list.
  * If that region does not have enough space, a new region may be created and
@@ -67,9 +177,23 @@ void gc_arena_destroy(GCArena arena, gc_status* out_status);
  * memory pool. If that region does not have enough space, the next region will
  * be considered. 
  *
+ * Regions the arena moves on from keep their remaining free space. They are
+ * tracked by the amount of free space left, and an allocation that does not
+ * fit inside the currently active region goes to the first of them that can
+ * hold it (GC_ARENA_ATOMIC arenas do not do this). Taking a GCArenaMark stops
+ * the regions before the mark from being used this way.
+ *
+ * If 'size' is greater than the arena's 'region_cap'('max_region_cap' when
+ * regions grow), a large region is used instead (see above). Large
+ * allocations always take the arena's lock.
+ *
+ * If the arena was created with GC_ARENA_THREAD_CACHE, the memory is taken from
+ * the calling thread's chunk. A new chunk is taken from the currently active
+ * region only when the thread's chunk does not have enough space.
+ *
  * STATUS CODES: 
  *   1. GC_SUCCESS - function call was successful;
- *   2. GC_ERR_INVALID_ARG - if 'size' is 0 or greater than arena's 'region_cap';
+ *   2. GC_ERR_INVALID_ARG - if 'size' is 0;
  *   3. GC_ERR_ALLOC_FAIL - if malloc() fails.
  *
  * Calling gc_arena_destroy multiple times on a single GCArena is undefined
@@ -82,6 +206,25 @@ void gc_arena_destroy(GCArena arena, gc_status* out_status);
 
 void* gc_arena_malloc(GCArena arena, size_t size, gc_status* out_status);
 
+/* ------------------------------------------------------ */
+
+/* Allocates 'size' bytes inside the arena, aligned to 'align' bytes. Padding
+ * needed to align the allocation is taken from the region. gc_arena_malloc()
+ * and gc_arena_calloc() align to _Alignof(max_align_t).
+ *
+ * STATUS CODES: 
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'size' is 0 or 'align' is not a power of two;
+ *   3. GC_ERR_ALLOC_FAIL - if malloc() fails.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: address of the newly-allocated memory inside the arena
+ *   of 'size' bytes, aligned to 'align' bytes;
+ *   ON FAILURE: NULL. */
+
+void* gc_arena_malloc_aligned(GCArena arena, size_t size, size_t align,
+        gc_status* out_status);
+
 /* -------------------------------------------------------------------------- */
 
 /* This function allocates a zero-initialized memory block of the given size 
@@ -94,32 +237,339 @@ void* gc_arena_calloc(GCArena arena, size_t size, gc_status* out_status);
 
 /* -------------------------------------------------------------------------- */
 
+/* Allocates 'n' blocks at once - block 'i' is 'sizes[i]' bytes long. Their
+ * addresses are stored in 'out_ptrs'('n' elements). Each block is aligned
+ * like a gc_arena_malloc() allocation.
+ *
+ * The blocks are reserved as a single contiguous allocation, in order - this
+ * costs a single lock acquisition(or a single CAS/thread chunk bump, see
+ * GC_ARENA_ATOMIC and GC_ARENA_THREAD_CACHE), instead of 'n' of them. A batch
+ * larger than a region gets a large region of its own.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'arena', 'sizes' or 'out_ptrs' is NULL, 'n' is
+ *   0, any of the sizes is 0 or the total size overflows;
+ *   3. GC_ERR_ALLOC_FAIL - if the allocation failed. 'out_ptrs' is left
+ *   untouched. */
+
+void gc_arena_malloc_batch(GCArena arena, const size_t* sizes, size_t n,
+        void** out_ptrs, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Works like gc_arena_malloc_batch(), but all 'n' blocks are 'size' bytes
+ * long.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'arena' or 'out_ptrs' is NULL, 'size' or 'n'
+ *   is 0 or the total size overflows;
+ *   3. GC_ERR_ALLOC_FAIL - if the allocation failed. 'out_ptrs' is left
+ *   untouched. */
+
+void gc_arena_malloc_batch_uniform(GCArena arena, size_t size, size_t n,
+        void** out_ptrs, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Resizes the allocation 'ptr' of 'old_size' bytes to 'new_size' bytes.
+ *
+ * If 'ptr' is the most recent allocation in the active region(or, for
+ * GC_ARENA_THREAD_CACHE arenas, in the calling thread's chunk) and the region
+ * has room, the allocation is resized in place, by moving the end of the used
+ * space - growing a buffer that is built at the end of the arena costs no
+ * copy. Shrinking such an allocation gives the space back to the arena.
+ * Otherwise, a growing allocation is copied into new space(aligned to
+ * _Alignof(max_align_t)) and a shrinking one is returned as it is. The old
+ * space is not reused until the arena is rewound.
+ *
+ * If 'ptr' is NULL, this is equivalent to gc_arena_malloc(arena, new_size).
+ * 'ptr' must have been returned by 'arena' in the current cycle and
+ * 'old_size' must be the size it was allocated(or last resized) with.
+ * Rewinding to a GCArenaMark taken before an allocation was grown in place
+ * also releases the grown part.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: address of the resized allocation('ptr' or a copy);
+ *   ON FAILURE: NULL - 'ptr' is left untouched.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL or 'new_size' is 0;
+ *   3. GC_ERR_ALLOC_FAIL - if the allocation had to be copied and allocating
+ *   new space failed. */
+
+void* gc_arena_realloc(GCArena arena, void* ptr, size_t old_size,
+        size_t new_size, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
 /* This function resets the arena by marking all allocated memory within
  * existing regions as available for reuse. It does not free any memory
  * but instead sets all regions' used capacity to zero. 
  * If multiple regions exist, the arena enters 'rewind mode' allowing
  * previously allocated regions to be reused in order.
  *
+ * Chunks held by threads(GC_ARENA_THREAD_CACHE) are invalidated - each thread
+ * takes a new chunk on its next allocation. With GC_ARENA_TRIM_ON_REWIND,
+ * regions that were not used since the previous rewind are trimmed.
+ *
  * STATUS CODES: 
  *   1. GC_SUCCESS - function call was successful;
- *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL. */
+ *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL or a read-only file-backed
+ *   arena. */
 
 void gc_arena_rewind(GCArena arena, gc_status* out_status);
 
 /* -------------------------------------------------------------------------- */
 
-/* This function deallocates all allocated regions except the first one.
- * This means that all memory occupied by those regions will be freed.
+/* This function deallocates all allocated regions except the first one,
+ * along with all large regions.
+ * The released regions are kept in a small cache for reuse by the following
+ * cycles - regions that are not reused within a few cycles are freed.
  * The first region will be reset, making its memory available for reuse.
  * After this call, the arena will be in the same state as immediately
- * after gc_arena_init().
+ * after gc_arena_create().
+ *
+ * Chunks held by threads(GC_ARENA_THREAD_CACHE) are invalidated.
  *
  * STATUS CODES: 
  *   1. GC_SUCCESS - function call was successful;
- *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL. */
+ *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL or a read-only file-backed
+ *   arena. */
 
 void gc_arena_reset(GCArena arena, gc_status* out_status);
 
 /* -------------------------------------------------------------------------- */
 
+/* A savepoint inside a GCArena - the position of the arena's active region
+ * and how much of it was used. Taken with gc_arena_mark(). */
+
+typedef struct GCArenaMark
+{
+    void* _region;
+    size_t _used_cap;
+    uint64_t _large_seq;
+    uint64_t _cycle;
+} GCArenaMark;
+
+/* ------------------------------------------------------ */
+
+/* Takes a savepoint inside the arena. A later gc_arena_rewind_to() with the
+ * returned mark releases everything allocated after this call, while keeping
+ * the allocations made before it. This allows a long-lived arena to be used as
+ * a (nested) scratch allocator:
+ *
+ * GCArenaMark mark = gc_arena_mark(arena, NULL);
+ * ... allocate temporaries ...
+ * gc_arena_rewind_to(arena, mark, NULL);
+ *
+ * Marks are invalidated by gc_arena_rewind() and gc_arena_reset().
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL. */
+
+GCArenaMark gc_arena_mark(GCArena arena, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Rewinds the arena back to 'mark'. Regions used after the mark are emptied
+ * and reused in order, like after gc_arena_rewind(). Large allocations made
+ * after the mark are released as well. This takes time proportional to the
+ * number of regions walked.
+ *
+ * Marks must be rewound to in LIFO order - rewinding to a mark taken after the
+ * mark most recently rewound to is undefined behavior. The mark is per arena,
+ * not per thread: allocations made by other threads after the mark are
+ * released too, and thread chunks(GC_ARENA_THREAD_CACHE) are invalidated.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL or 'mark' was never taken;
+ *   3. GC_ERR_ARENA_STALE_MARK - the arena was rewound or reset after the
+ *   mark was taken. */
+
+void gc_arena_rewind_to(GCArena arena, GCArenaMark mark, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Snapshot of an arena's state, returned by gc_arena_stats(). */
+
+struct GCArenaStats
+{
+    /* Regions in the region list / large regions. */
+    size_t region_count;
+    size_t large_region_count;
+
+    /* Capacity of all regions, large regions included. */
+    size_t bytes_reserved;
+
+    /* Regions released by gc_arena_reset() and kept for reuse, and their
+     * capacity(not included in 'bytes_reserved'). A cached region that is
+     * not reused within a few cycles is freed. */
+    size_t cached_region_count;
+    size_t bytes_cached;
+
+    /* Bytes handed out, alignment padding included. With
+     * GC_ARENA_THREAD_CACHE, whole chunks taken by threads count as used. */
+    size_t bytes_used;
+
+    /* Free bytes left at the end of regions the arena has moved past. */
+    size_t tail_waste;
+
+    /* Highest 'bytes_used' since the last reset. Sampled when the arena is
+     * rewound and when a snapshot is taken. */
+    size_t peak_usage;
+
+    /* Since the arena was created: number of gc_arena_rewind() calls and
+     * number of regions allocated from the system(large regions included,
+     * regions reused from the cache not included).
+     * An arena whose 'region_allocs' keeps growing across rewinds thrashes
+     * its region list - its 'region_cap' is probably too small. */
+    size_t rewind_count;
+    size_t region_allocs;
+
+    /* Since the arena was created: acquisitions of the arena's lock and how
+     * many of them had to wait for another thread. Always 0 if the library
+     * is compiled with GC_ARENA_NO_STATS. */
+    size_t lock_acquisitions;
+    size_t lock_contentions;
+};
+
+/* ------------------------------------------------------ */
+
+/* Returns a snapshot of the arena's statistics. This takes the arena's lock
+ * and walks all regions. Counting on the allocation path is limited to the
+ * lock counters, which are updated while the lock is held anyway.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL. */
+
+struct GCArenaStats gc_arena_stats(GCArena arena, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* File-backed arenas.
+ *
+ * A file-backed arena has a single region living inside a file mapped with
+ * mmap()(MAP_SHARED) - the arena's "image". Data structures built inside it
+ * can be saved and opened again by another process, which maps the image
+ * without copying or rebuilding anything.
+ *
+ * The image may be mapped at a different address every time it is opened, so
+ * data inside it must not store pointers - it should store offsets instead
+ * (see gc_arena_offset()/gc_arena_ptr()). The offset of a NULL pointer is 0,
+ * which never refers to an allocation.
+ *
+ * A file-backed arena cannot grow: allocations that do not fit inside the
+ * image fail with GC_ERR_ALLOC_FAIL. It can be rewound and reset as usual.
+ * Images are only portable between machines with the same byte order and
+ * type layout. */
+
+/* Flags for gc_arena_open(). */
+
+/* The image is mapped read-only. The arena refuses to allocate, rewind or
+ * reset - it only serves to read the data already inside the image. */
+#define GC_ARENA_OPEN_READONLY (1 << 0)
+
+/* ------------------------------------------------------ */
+
+/* Creates(or truncates) the file at 'path', sizes it to 'size' bytes and
+ * creates a file-backed arena on top of it. 'size' includes a small header at
+ * the start of the image, so slightly less than 'size' bytes can be allocated.
+ * The file is sparse - disk space is only used for pages that are written to.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'path' is NULL or 'size' is too small;
+ *   3. GC_ERR_ARENA_IO - if the file could not be created, resized or mapped;
+ *   4. GC_ERR_ALLOC_FAIL - if malloc() fails.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: address of the newly-allocated struct GCArena;
+ *   ON FAILURE: NULL. */
+
+GCArena gc_arena_create_file(const char* path, size_t size,
+        gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Maps an image written by gc_arena_save() and creates a file-backed arena on
+ * top of it. 'flags' is a bitwise OR of GC_ARENA_OPEN_* flags. The image's
+ * header is validated before the arena is created. Unless the image is opened
+ * with GC_ARENA_OPEN_READONLY, new allocations continue after the saved data
+ * and the image can be saved again.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'path' is NULL;
+ *   3. GC_ERR_ARENA_IO - if the file could not be opened or mapped;
+ *   4. GC_ERR_ARENA_BAD_IMAGE - if the file is not a valid image(bad magic,
+ *   different byte order, sizes that do not match the file);
+ *   5. GC_ERR_ARENA_IMAGE_VERSION - if the image was written by an
+ *   incompatible version of the library;
+ *   6. GC_ERR_ALLOC_FAIL - if malloc() fails.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: address of the newly-allocated struct GCArena;
+ *   ON FAILURE: NULL. */
+
+GCArena gc_arena_open(const char* path, int flags, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Records the amount of used memory and the root object 'root'(an
+ * allocation of the arena, may be NULL) in the image's header and flushes the
+ * whole image to the file(msync()). gc_arena_root() returns 'root' after the
+ * image is opened again.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL, not file-backed, read-only
+ *   or if 'root' does not point inside the arena's used memory;
+ *   3. GC_ERR_ARENA_IO - if flushing the image failed. */
+
+void gc_arena_save(GCArena arena, const void* root, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Returns the root object recorded by the last gc_arena_save(), NULL if none.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL or not file-backed. */
+
+void* gc_arena_root(GCArena arena, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Convert between pointers into a file-backed arena's image and offsets
+ * relative to the start of the image. NULL and 0 map to each other. These do
+ * not check their arguments - 'arena' must be a valid file-backed arena and
+ * 'ptr'/'offset' must refer to its image. */
+
+uint64_t gc_arena_offset(GCArena arena, const void* ptr);
+
+void* gc_arena_ptr(GCArena arena, uint64_t offset);
+
+/* -------------------------------------------------------------------------- */
+
+/* Returns a GCAllocator that allocates from 'arena'. Containers created with
+ * it(see _gc_vec_create_with(), gc_str_create_with(), ...) live inside the
+ * arena and are released together with everything else by gc_arena_rewind()
+ * or gc_arena_reset() - destroying them first is allowed, but not necessary.
+ *
+ * The allocator's free is a no-op. Its realloc is gc_arena_realloc() - an
+ * arena-backed vector or string that is the arena's most recent allocation
+ * grows without copying.
+ * Allocations are aligned to _Alignof(max_align_t). Assumes that 'arena' is
+ * a valid GCArena that outlives every container using the allocator. */
+
+struct GCAllocator gc_arena_allocator(GCArena arena);
+
+/* -------------------------------------------------------------------------- */
+
 #endif // _GC_ARENA_H_
@@ -0,0 +1,145 @@
+#ifndef _GC_POOL_H_
+#define _GC_POOL_H_
+
+#include "gc_shared.h"
+#include "arena/gc_arena.h"
+#include <stdlib.h>
+
+/* -------------------------------------------------------------------------- */
+
+/* GCPool is a thread-safe allocator for fixed-size objects. It carves slabs
+ * out of a GCArena and, unlike the arena, allows individual objects to be
+ * released and reused. Released objects are kept on an intrusive free list
+ * (the link is stored inside the free object itself), so both
+ * gc_pool_acquire() and gc_pool_release() are O(1).
+ *
+ * The pool does not own the arena. Slabs are never returned to the arena -
+ * they are released together with everything else when the arena is rewound
+ * or reset. After that, the pool must be emptied with gc_pool_reset() before
+ * it is used again.
+ *
+ * When many threads acquire and release objects from the same pool, the pool
+ * can be created with GC_POOL_THREAD_CACHE. In this mode, each thread keeps a
+ * small stack of free objects(a "magazine"). Acquires and releases are served
+ * from the magazine without locking; the pool's lock is only taken to refill
+ * an empty magazine or to drain a full one, half a magazine at a time. */
+
+typedef struct GCPool* GCPool;
+
+/* -------------------------------------------------------------------------- */
+
+/* Flags for struct GCPoolOptions. */
+
+/* Each thread caches free objects in its own magazine. A thread keeps
+ * magazines for a few pools at a time - if it uses more pools than that, one
+ * of its magazines is drained back into its pool to make room. Magazines are
+ * also drained when their thread exits. */
+#define GC_POOL_THREAD_CACHE (1 << 0)
+
+/* ------------------------------------------------------ */
+
+/* Options used to create a GCPool with gc_pool_create_(). A zero-initialized
+ * struct describes the default pool (the one created by gc_pool_create()). */
+
+struct GCPoolOptions
+{
+    /* Bitwise OR of GC_POOL_* flags. */
+    int flags;
+
+    /* Number of objects in each slab carved out of the arena. If 0, enough
+     * objects to fill 16KB(at least 1) are used. */
+    size_t slab_objects;
+
+    /* GC_POOL_THREAD_CACHE only - number of objects a magazine can hold. If 0,
+     * 32 is used. Must not be greater than 64. */
+    size_t magazine_size;
+};
+
+/* -------------------------------------------------------------------------- */
+
+/* Dynamically allocates memory for 'struct GCPool' and initializes it. The
+ * pool hands out objects of 'obj_size' bytes, aligned to 'align' bytes, from
+ * slabs allocated inside 'arena'. If 'align' is 0, _Alignof(max_align_t) is
+ * used. Objects are at least pointer-sized and pointer-aligned.
+ *
+ * No slabs are allocated until the first gc_pool_acquire().
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL, 'obj_size' is 0, 'align' is
+ *   not a power of two or the options are invalid;
+ *   3. GC_ERR_ALLOC_FAIL - if malloc() fails.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: address of the newly-allocated struct GCPool;
+ *   ON FAILURE: NULL. */
+
+GCPool gc_pool_create(GCArena arena, size_t obj_size, size_t align,
+        gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Creates a GCPool configured by 'options'. gc_pool_create() is equivalent
+ * to calling this function with a zero-initialized struct GCPoolOptions.
+ *
+ * For RETURN VALUE and STATUS CODES, see gc_pool_create(). */
+
+GCPool gc_pool_create_(GCArena arena, size_t obj_size, size_t align,
+        struct GCPoolOptions options, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Destroys the pool. This frees the struct GCPool itself - the slabs stay
+ * inside the arena until it is rewound or reset.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'pool' is NULL. */
+
+void gc_pool_destroy(GCPool pool, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Returns an object from the pool. Released objects are reused first; if
+ * there are none, the object is carved out of the current slab, allocating
+ * a new slab from the arena if needed. The object's content is unspecified.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'pool' is NULL;
+ *   3. GC_ERR_ALLOC_FAIL - if the arena failed to allocate a new slab.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: address of the object;
+ *   ON FAILURE: NULL. */
+
+void* gc_pool_acquire(GCPool pool, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Returns the object 'obj' to the pool. 'obj' must have been returned by
+ * gc_pool_acquire() on the same pool and must not be released twice - this is
+ * not checked.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'pool' or 'obj' is NULL. */
+
+void gc_pool_release(GCPool pool, void* obj, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Empties the pool - forgets its free list, its current slab and all of the
+ * threads' magazines. Must be called after the arena has been rewound or
+ * reset, before the pool is used again. Objects acquired before the reset
+ * must not be released afterwards.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'pool' is NULL. */
+
+void gc_pool_reset(GCPool pool, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+#endif // _GC_POOL_H_
@@ -0,0 +1,91 @@
+#ifndef _GC_SCRATCH_H_
+#define _GC_SCRATCH_H_
+
+#include "gc_shared.h"
+#include "arena/gc_arena.h"
+#include <stdlib.h>
+
+/* -------------------------------------------------------------------------- */
+
+/* Scratch arenas are built-in, per-thread GCArenas for short-lived memory.
+ * Each thread has two of them, created lazily on the thread's first
+ * gc_scratch_begin(). They are GC_ARENA_SINGLE_THREAD arenas - owned by the
+ * thread, they never take a lock.
+ *
+ * A scratch scope starts with gc_scratch_begin(), which takes a GCArenaMark
+ * inside one of the arenas, and ends with gc_scratch_end(), which rewinds the
+ * arena back to it:
+ *
+ * GCScratch scratch = gc_scratch_begin(NULL, NULL);
+ * ... allocate temporaries from scratch.arena ...
+ * gc_scratch_end(scratch, NULL);
+ *
+ * Two arenas let a function return its result in one arena while using the
+ * other one for temporaries. A function that receives an arena to allocate
+ * its result in passes it as 'conflict' - the scope is then opened in the
+ * other scratch arena, so ending it does not release the result:
+ *
+ * GCString build(GCArena out)
+ * {
+ *     GCScratch scratch = gc_scratch_begin(out, NULL);
+ *     ... temporaries in scratch.arena, the result in 'out' ...
+ *     gc_scratch_end(scratch, NULL);
+ * }
+ *
+ * Scopes must be ended in LIFO order(per arena - see gc_arena_rewind_to()).
+ * Memory from a scratch arena must not be used by other threads after the
+ * scope ends, and never after the owning thread exits - the arenas are
+ * destroyed then. */
+
+/* A scratch scope, returned by gc_scratch_begin(). 'arena' is the scratch
+ * arena to allocate from. */
+
+typedef struct GCScratch
+{
+    GCArena arena;
+    GCArenaMark _mark;
+} GCScratch;
+
+/* -------------------------------------------------------------------------- */
+
+/* Starts a scratch scope inside one of the calling thread's scratch arenas -
+ * the first one that is not 'conflict'('conflict' may be NULL or any other
+ * GCArena). The arenas are created on the thread's first call.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_ALLOC_FAIL - if the scratch arena had to be created and that
+ *   failed.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: the scratch scope;
+ *   ON FAILURE: a scope whose 'arena' is NULL. */
+
+GCScratch gc_scratch_begin(GCArena conflict, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Ends the scratch scope - everything allocated in 'scratch.arena' since the
+ * matching gc_scratch_begin() is released. Ending a scope twice, or after
+ * an outer scope of the same arena was ended, is undefined behavior.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'scratch.arena' is NULL. */
+
+void gc_scratch_end(GCScratch scratch, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Destroys the calling thread's scratch arenas, if they were created. They
+ * are destroyed automatically when a thread exits - this is only needed to
+ * return their memory early(or for the main thread). No scope may be open.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful. */
+
+void gc_scratch_release(gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+#endif // _GC_SCRATCH_H_
@@ -0,0 +1,187 @@
+#ifndef _GC_SHARDED_ARENA_H_
+#define _GC_SHARDED_ARENA_H_
+
+#include "gc_shared.h"
+#include "arena/gc_arena.h"
+#include "alloc/gc_allocator.h"
+#include <stdlib.h>
+
+/* -------------------------------------------------------------------------- */
+
+/* GCShardedArena is a front end for several independent GCArenas("shards").
+ * Each allocation is served by one shard, chosen by the CPU the calling
+ * thread runs on(or by the calling thread). Threads running on different
+ * CPUs therefore allocate from different arenas - they do not share a lock
+ * or an active region, and allocation scales with the number of CPUs.
+ *
+ * The lifetime model is the same as the GCArena's: gc_sharded_arena_rewind()
+ * and gc_sharded_arena_reset() apply to all shards at once. Like with a
+ * GCArena, they must not be called while other threads allocate.
+ *
+ * Shards are created lazily, on the first allocation that selects them, so
+ * unused shards cost no memory. */
+
+typedef struct GCShardedArena* GCShardedArena;
+
+/* -------------------------------------------------------------------------- */
+
+/* Shard selection policies for struct GCShardedArenaOptions. */
+
+/* The shard is chosen by the CPU the calling thread currently runs on
+ * (sched_getcpu()). Falls back to GC_SHARDED_ARENA_BY_THREAD if the CPU
+ * cannot be determined. */
+#define GC_SHARDED_ARENA_BY_CPU 0
+
+/* Each thread is assigned a shard(round-robin, in the order in which threads
+ * first allocate from any GCShardedArena) and keeps it. */
+#define GC_SHARDED_ARENA_BY_THREAD 1
+
+/* ------------------------------------------------------ */
+
+/* Options used to create a GCShardedArena with gc_sharded_arena_create_().
+ * A zero-initialized struct describes the default sharded arena (the one
+ * created by gc_sharded_arena_create()). */
+
+struct GCShardedArenaOptions
+{
+    /* Number of shards. If 0, the number of CPUs is used. Must not be so
+     * large that the shard table's size overflows. */
+    size_t shard_count;
+
+    /* One of GC_SHARDED_ARENA_BY_*. */
+    int shard_policy;
+
+    /* Options each shard is created with(see gc_arena_create_()).
+     * GC_ARENA_SINGLE_THREAD is not allowed. */
+    struct GCArenaOptions arena_options;
+};
+
+/* -------------------------------------------------------------------------- */
+
+/* Dynamically allocates memory for 'struct GCShardedArena' and initializes
+ * it. Each shard is a GCArena with regions of 'region_cap' bytes.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'region_cap' is 0 or the options are invalid;
+ *   3. GC_ERR_ALLOC_FAIL - if malloc() fails.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: address of the newly-allocated struct GCShardedArena;
+ *   ON FAILURE: NULL. */
+
+GCShardedArena gc_sharded_arena_create(size_t region_cap,
+        gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Creates a GCShardedArena configured by 'options'. gc_sharded_arena_create()
+ * is equivalent to calling this function with a zero-initialized struct
+ * GCShardedArenaOptions.
+ *
+ * For RETURN VALUE and STATUS CODES, see gc_sharded_arena_create().
+ * Additionally, GC_ERR_INVALID_ARG is returned if 'options.arena_options'
+ * has GC_ARENA_SINGLE_THREAD set - a shard can be used by several threads at
+ * once. */
+
+GCShardedArena gc_sharded_arena_create_(size_t region_cap,
+        struct GCShardedArenaOptions options, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Destroys the sharded arena and all of its shards.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL. */
+
+void gc_sharded_arena_destroy(GCShardedArena arena, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Returns the shard the calling thread would allocate from right now,
+ * creating it if needed. Useful to take GCArenaMarks or to use other GCArena
+ * functions directly. With GC_SHARDED_ARENA_BY_CPU, the thread may be moved
+ * to another CPU(and shard) at any time - the returned shard stays valid, it
+ * is just no longer local.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL;
+ *   3. GC_ERR_ALLOC_FAIL - if the shard had to be created and that failed.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: the shard;
+ *   ON FAILURE: NULL. */
+
+GCArena gc_sharded_arena_shard(GCShardedArena arena, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Allocates from the calling thread's shard - see gc_arena_malloc(),
+ * gc_arena_malloc_aligned() and gc_arena_calloc() for RETURN VALUE and
+ * STATUS CODES. */
+
+void* gc_sharded_arena_malloc(GCShardedArena arena, size_t size,
+        gc_status* out_status);
+
+void* gc_sharded_arena_malloc_aligned(GCShardedArena arena, size_t size,
+        size_t align, gc_status* out_status);
+
+void* gc_sharded_arena_calloc(GCShardedArena arena, size_t size,
+        gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Resizes 'ptr' using the calling thread's shard - see gc_arena_realloc().
+ * 'ptr' may have been allocated by any shard of 'arena'. It is resized in
+ * place only if it is the last allocation of the calling thread's shard,
+ * otherwise it is copied. */
+
+void* gc_sharded_arena_realloc(GCShardedArena arena, void* ptr,
+        size_t old_size, size_t new_size, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Rewinds every shard - see gc_arena_rewind().
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL. */
+
+void gc_sharded_arena_rewind(GCShardedArena arena, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Resets every shard - see gc_arena_reset().
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL. */
+
+void gc_sharded_arena_reset(GCShardedArena arena, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Returns the statistics of all shards, added together. Note that
+ * 'peak_usage' is the sum of per-shard peaks, not the peak of the whole
+ * arena - the shards may have peaked at different times, so it can overstate
+ * the arena's real high-water mark(it is an upper bound on it).
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - function call was successful;
+ *   2. GC_ERR_INVALID_ARG - if 'arena' is NULL. */
+
+struct GCArenaStats gc_sharded_arena_stats(GCShardedArena arena,
+        gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Returns a GCAllocator that allocates from the calling thread's shard. See
+ * gc_arena_allocator(). Assumes that 'arena' is a valid GCShardedArena. */
+
+struct GCAllocator gc_sharded_arena_allocator(GCShardedArena arena);
+
+/* -------------------------------------------------------------------------- */
+
+#endif // _GC_SHARDED_ARENA_H_
@@ -2,7 +2,9 @@
 #define __GC_ARRAY_H__
 
 #include "gc_shared.h"
+#include "alloc/gc_allocator.h"
 #include <stddef.h>
+#include <stdbool.h>
 
 struct __GCArray
 {
@@ -19,8 +21,52 @@ struct __GCArray
     
     /* el_size - size of single element(bytes) */
     size_t _el_size;
+
+    /* allocator - every allocation made by the array(including the struct
+     * itself) goes through this allocator */
+    struct GCAllocator _allocator;
+
+    /* mapped - the data field was mapped with mmap() instead of being
+     * allocated through the allocator(see __GC_ARR_MMAP_THRESHOLD) */
+    bool _mapped;
+
+    /* inline_cap - number of elements that fit inside the inline storage
+     * placed right after the struct, in the same allocation(0 if the struct
+     * has no inline storage). The data field points to the inline storage
+     * until the array outgrows it. */
+    size_t _inline_cap;
 };
 
+/* Offset of the inline storage from the start of the struct. */
+#define __GC_ARR_INLINE_OFFSET                                                 \
+    ((sizeof(struct __GCArray) + (_Alignof(max_align_t) - 1)) &                \
+     ~(_Alignof(max_align_t) - 1))
+
+/* Assumptions:
+ * 1. 'array' is a valid _GCArray. */
+#define __gc_arr_inline_data(array) ((char*)(array) + __GC_ARR_INLINE_OFFSET)
+
+/* Assumptions:
+ * 1. 'array' is a valid _GCArray. */
+#define __gc_arr_is_inline(array)                                              \
+    (((array)->_inline_cap > 0) &&                                             \
+     ((char*)(array)->_data == __gc_arr_inline_data(array)))
+
+/* Size of the allocation holding the struct(and its inline storage).
+ * Assumptions:
+ * 1. 'array' is a valid _GCArray. */
+#define __gc_arr_struct_size(array)                                            \
+    (((array)->_inline_cap > 0) ?                                              \
+     (__GC_ARR_INLINE_OFFSET + ((array)->_inline_cap * (array)->_el_size)) :   \
+     sizeof(struct __GCArray))
+
+/* Data fields of at least this many bytes are mapped directly with mmap() and
+ * grown with mremap(), which moves pages instead of copying them - unless the
+ * array uses a custom allocator. */
+#ifndef __GC_ARR_MMAP_THRESHOLD
+#define __GC_ARR_MMAP_THRESHOLD (1 << 20)
+#endif
+
 /* The following functions and macros do not check for errors. They perform
  * under specific assumptions. These assumptions should be checked for before
  * using the listed functions/macros. */
@@ -28,16 +74,37 @@ struct __GCArray
 /* Assumptions:
  * 1. 'array' is a pointer to a valid struct __GCArray
  * 2. 'cap' > 0,
- * 3. 'el_size' > 0.
+ * 3. 'el_size' > 0,
+ * 4. 'allocator' is a pointer to a valid struct GCAllocator.
  * Initializes the provided struct __GCArray. ERRORS: GC_ERR_ALLOC_FAIL */
-void __gc_arr_init(struct __GCArray* array, size_t cap,
-        size_t el_size, gc_status* out_status);
+void __gc_arr_init(struct __GCArray* array, size_t cap, size_t el_size,
+        const struct GCAllocator* allocator, gc_status* out_status);
+
+/* Assumptions:
+ * 1. 'array' points to an allocation of at least __GC_ARR_INLINE_OFFSET +
+ * 'inline_cap' * 'el_size' bytes,
+ * 2. 'inline_cap' > 0,
+ * 3. 'el_size' > 0,
+ * 4. 'allocator' is a pointer to a valid struct GCAllocator.
+ * Initializes the provided struct __GCArray so that its data field is the
+ * inline storage following the struct. Cannot fail. */
+void __gc_arr_init_inline(struct __GCArray* array, size_t inline_cap,
+        size_t el_size, const struct GCAllocator* allocator);
 
 /* Assumptions:
  * 1. 'array' is a pointer to a valid struct __GCArray.
- * Destroys the provided struct __GCArray. ERRORS: GC_ERR_INVALID_ARG */
+ * Destroys the provided struct __GCArray. Does not free the struct itself.
+ * ERRORS: GC_ERR_INVALID_ARG */
 void __gc_arr_destroy(struct __GCArray* array);
 
+/* Assumptions:
+ * 1. 'array' is a pointer to a valid struct __GCArray,
+ * 2. 'new_cap' * array->_el_size does not overflow.
+ * Resizes the array's data field so that it can store 'new_cap' elements.
+ * Returns the new data field, or NULL on failure, in which case the array is
+ * left untouched. Does not update array->_data and array->_capacity. */
+void* __gc_arr_realloc(struct __GCArray* array, size_t new_cap);
+
 /* Assumptions:
  * 1. 'array' is a valid _GCArray,
  * 2. 'pos' is a valid position inside the array. */
@@ -52,6 +119,15 @@ void __gc_arr_destroy(struct __GCArray* array);
 void __gc_arr_insert(struct __GCArray* array, size_t pos, const void* data_arr,
         size_t data_size);
 
+/* Assumptions:
+ * 1. 'array' is a valid _GCArray,
+ * 2. 'pos' <= array->_size,
+ * 3. 'array' has enough capacity to store additional 'count' elements.
+ * Shifts the elements right of(including) 'pos' rightward by 'count'
+ * positions and adds 'count' elements to the array's size. Returns the address
+ * of position 'pos' - the 'count' opened slots are left uninitialized. */
+void* __gc_arr_open(struct __GCArray* array, size_t pos, size_t count);
+
 /* 'start_pos' is included, 'end_pos' is not included.
  * Assumptions:
  * 1. 'array' is a valid _GCArray,,
@@ -15,10 +15,11 @@ struct __GCVector
 /* Assumptions:
  * 1. 'vector' is a pointer to a valid struct __GCVector
  * 2. 'cap' > 0,
- * 3. 'el_size' > 0.
+ * 3. 'el_size' > 0,
+ * 4. 'allocator' is a pointer to a valid struct GCAllocator.
  * Initializes the provided struct __GCVector. ERRORS: GC_ERR_ALLOC_FAIL */
-void __gc_vec_init(struct __GCVector* vector, size_t cap,
-        size_t el_size, gc_status* out_status);
+void __gc_vec_init(struct __GCVector* vector, size_t cap, size_t el_size,
+        const struct GCAllocator* allocator, gc_status* out_status);
 
 /* Assumptions:
  * 1. 'vector' is a pointer to a valid struct __GCVector.
@@ -2,7 +2,10 @@
 #define _GC_ARRAY_H_
 
 #include "gc_shared.h"
+#include "alloc/gc_allocator.h"
+#include "ds/_gc_array.h"
 #include <stdlib.h>
+#include <string.h>
 
 /* -------------------------------------------------------------------------- */
 
@@ -52,6 +55,27 @@ _GCArray _gc_arr_create(size_t capacity, size_t el_size, gc_status* out_status);
 
 /* ------------------------------------------------------ */
 
+/* INTERNAL FUNCTION - use a convenience macro instead.
+ *
+ * Works like _gc_arr_create(), but every allocation made by the array -
+ * the struct __GCArray itself, its data field and any later resize - goes
+ * through 'allocator'. The array keeps a copy of 'allocator'.
+ *
+ * RETURN VALUES:
+ *   ON SUCCESS: Address of the newly allocated _GCArray,
+ *   ON FAILURE: NULL.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_ALLOC_FAIL - 'allocator' failed to allocate memory,
+ *   3. GC_ERR_INVALID_ARG - provided 'el_size' or 'capacity' is equal to 0 or
+ *   'allocator' is NULL. */
+
+_GCArray _gc_arr_create_with(size_t capacity, size_t el_size,
+        const struct GCAllocator* allocator, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
 /* Destroys the array. Sets its fields to default values. Frees the dynamically
  * allocated memory for the array and the array's data field.
  *
@@ -127,6 +151,77 @@ void _gc_arr_insert(_GCArray array, const void* data, size_t pos,
 
 void _gc_arr_push_back(_GCArray array, const void* data, gc_status* out_status);
 
+/* ------------------------------------------------------ */
+
+/* Inserts 'count' elements, copied from 'data_arr', at position 'pos'. All
+ * elements right of(including) 'pos' are shifted rightward once, by 'count'
+ * positions. 'data_arr' must hold 'count' elements and must not point inside
+ * the array. Works the same way for value and pointer arrays - for a pointer
+ * array, 'data_arr' is an array of pointers.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'array' is NULL or 'data_arr' is NULL while
+ *   'count' is not 0,
+ *   3. GC_ERR_OUT_OF_BOUNDS - 'pos' is out of bounds,
+ *   4. GC_ERR_ARRAY_NO_CAP - 'array' doesn't have enough capacity to insert
+ *   'count' new elements. Nothing is inserted. */
+
+void gc_arr_insert_n(_GCArray array, const void* data_arr, size_t count,
+        size_t pos, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Appends 'count' elements, copied from 'data_arr', to the end of the array.
+ * See gc_arr_insert_n().
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'array' is NULL or 'data_arr' is NULL while
+ *   'count' is not 0,
+ *   3. GC_ERR_ARRAY_NO_CAP - 'array' doesn't have enough capacity to append
+ *   'count' new elements. Nothing is appended. */
+
+void gc_arr_append_n(_GCArray array, const void* data_arr, size_t count,
+        gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Inserts a new, uninitialized element at position 'pos' and returns its
+ * address, so that the caller can construct the element in place instead of
+ * copying it in. All elements right of(including) 'pos' are shifted
+ * rightward. The address is valid until the array is modified.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: address of the new element,
+ *   ON FAILURE: NULL.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'array' is NULL,
+ *   3. GC_ERR_OUT_OF_BOUNDS - 'pos' is out of bounds,
+ *   4. GC_ERR_ARRAY_NO_CAP - 'array' doesn't have enough capacity to insert
+ *   a new element. */
+
+void* gc_arr_emplace_at(_GCArray array, size_t pos, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Appends a new, uninitialized element to the end of the array and returns
+ * its address. See gc_arr_emplace_at().
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: address of the new element,
+ *   ON FAILURE: NULL.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'array' is NULL,
+ *   3. GC_ERR_ARRAY_NO_CAP - 'array' doesn't have enough capacity to append
+ *   a new element. */
+
+void* gc_arr_emplace_back(_GCArray array, gc_status* out_status);
+
 /* -------------------------------------------------------------------------- */
 
 /* Removes element with position 'pos' from the array. This causes all elements
@@ -141,6 +236,33 @@ void gc_arr_remove(_GCArray array, size_t pos, gc_status* out_status);
 
 /* ------------------------------------------------------ */
 
+/* Removes elements with positions in range ['start_pos', 'end_pos') from the
+ * array. All elements right of the range are shifted leftward once.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'array' is NULL,
+ *   3. GC_ERR_OUT_OF_BOUNDS - 'start_pos' > 'end_pos' or 'end_pos' is greater
+ *   than the array's size. */
+
+void gc_arr_remove_range(_GCArray array, size_t start_pos, size_t end_pos,
+        gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Removes element with position 'pos' from the array in O(1) - the last
+ * element is moved into its place. Unlike gc_arr_remove(), this does not
+ * preserve the order of the elements.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'array' is NULL,
+ *   3. GC_ERR_OUT_OF_BOUNDS - 'pos' is out of bounds. */
+
+void gc_arr_swap_remove(_GCArray array, size_t pos, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
 /* Removes the last element inside the array.
  * STATUS CODES:
  *   1. GC_SUCCESS - Function call was successful,
@@ -156,10 +278,15 @@ void gc_arr_pop_back(_GCArray array, gc_status* out_status);
  * array capacity. If the re-allocation fails, an error code will be provided
  * and the array's internal state will remain unchanged.
  *
+ * Unless the array uses a custom allocator, data fields of at least
+ * __GC_ARR_MMAP_THRESHOLD bytes(1MB by default) are mapped with mmap() and
+ * grown with mremap() - the pages are remapped instead of copied, so growing a
+ * large array neither copies it nor briefly needs twice the memory.
+ *
  * STATUS CODES:
  *   1. GC_SUCCESS - Function call was successful,
  *   2. GC_ERR_INVALID_ARG - 'array' is NULL OR 'capacity' < current array cap,
- *   3. GC_ERR_ALLOC_FAIL - realloc() returned NULL. */
+ *   3. GC_ERR_ALLOC_FAIL - realloc()(or mremap()) failed. */
 
 void gc_arr_reserve(_GCArray array, size_t capacity, gc_status* out_status);
 
@@ -175,6 +302,50 @@ void gc_arr_reserve(_GCArray array, size_t capacity, gc_status* out_status);
 
 void gc_arr_fit(_GCArray array, gc_status* out_status);
 
+/* UNCHECKED ACCESSORS ------------------------------------------------------ */
+
+/* The following functions are defined in the header, so that the compiler
+ * can inline them into tight loops. They do not check their arguments and do
+ * not report a status - every assumption listed must be checked by the
+ * caller. Breaking one of them is undefined behavior. */
+
+/* Assumptions:
+ * 1. 'array' is a valid _GCArray. */
+static inline size_t gc_arr_size_unchecked(const _GCArray array)
+{
+    return array->_size;
+}
+
+/* Assumptions:
+ * 1. 'array' is a valid _GCArray,
+ * 2. 'pos' < array's size. */
+static inline void* _gc_arr_at_unchecked(const _GCArray array, size_t pos)
+{
+    return (char*)array->_data + (pos * array->_el_size);
+}
+
+/* Assumptions:
+ * 1. 'array' is a valid _GCArray,
+ * 2. 'pos' < array's size,
+ * 3. 'data' points to an element-sized value. */
+static inline void _gc_arr_set_unchecked(_GCArray array, const void* data,
+        size_t pos)
+{
+    memcpy(_gc_arr_at_unchecked(array, pos), data, array->_el_size);
+}
+
+/* Assumptions:
+ * 1. 'array' is a valid _GCArray,
+ * 2. array's size < array's capacity,
+ * 3. 'data' points to an element-sized value. */
+static inline void _gc_arr_push_back_unchecked(_GCArray array,
+        const void* data)
+{
+    memcpy((char*)array->_data + (array->_size * array->_el_size), data,
+            array->_el_size);
+    array->_size++;
+}
+
 /* CONVENIENCE MACROS ------------------------------------------------------- */
 
 /* 'type' refers to the data type stored inside the array. */
@@ -195,6 +366,9 @@ typedef _GCArray GCVArray;
 #define gc_arr_create_val(init_cap, type, out_status) \
     _gc_array_create((init_cap), sizeof(type), (out_status))
 
+#define gc_arr_create_val_with(init_cap, type, allocator, out_status) \
+    _gc_arr_create_with((init_cap), sizeof(type), (allocator), (out_status))
+
 /* Returns pointer to the element inside the array and casts the pointer to
  * type*. If _gc_arr_at() fails, the result may be NULL. */
 #define gc_arr_at_val(valarr, pos, out_status, type) \
@@ -209,6 +383,16 @@ typedef _GCArray GCVArray;
 #define gc_arr_push_back_val(valarr, data, out_status) \
     _gc_array_push_back((valarr), (data), (out_status))
 
+/* Unchecked variants - see UNCHECKED ACCESSORS above. */
+#define gc_arr_at_val_unchecked(valarr, pos, type) \
+    (type *)_gc_arr_at_unchecked((valarr), (pos))
+
+#define gc_arr_set_val_unchecked(valarr, data, pos) \
+    _gc_arr_set_unchecked((valarr), (data), (pos))
+
+#define gc_arr_push_back_val_unchecked(valarr, data) \
+    _gc_arr_push_back_unchecked((valarr), (data))
+
 /* -------------------------------------------------------------------------- */
 
 /* Pointer array - stores pointers inside the array.
@@ -229,6 +413,9 @@ typedef _GCArray GCPArray;
 #define gc_arr_create_ptr(init_cap, out_status) \
     _gc_array_create((init_cap), sizeof(void*), (out_status))
 
+#define gc_arr_create_ptr_with(init_cap, allocator, out_status) \
+    _gc_arr_create_with((init_cap), sizeof(void*), (allocator), (out_status))
+
 /* Finds the address of element inside the array with position 'pos'.
  * This is a double pointer, because the element itself is a pointer.
  * It casts this double pointer to the appropriate type. Then, the
@@ -248,4 +435,14 @@ typedef _GCArray GCPArray;
 #define gc_arr_push_back_ptr(ptrarr, data, out_status) \
     _gc_array_push_back((ptrarr), &(data), (out_status))
 
+/* Unchecked variants - see UNCHECKED ACCESSORS above. */
+#define gc_arr_at_ptr_unchecked(ptrarr, pos, type) \
+    *(type **)_gc_arr_at_unchecked((ptrarr), (pos))
+
+#define gc_arr_set_ptr_unchecked(ptrarr, data, pos) \
+    _gc_arr_set_unchecked((ptrarr), &(data), (pos))
+
+#define gc_arr_push_back_ptr_unchecked(ptrarr, data) \
+    _gc_arr_push_back_unchecked((ptrarr), &(data))
+
 #endif // _GC_ARRAY_H_
@@ -0,0 +1,185 @@
+#ifndef _GC_CONC_VECTOR_H_
+#define _GC_CONC_VECTOR_H_
+
+#include <stdlib.h>
+#include "gc_shared.h"
+#include "alloc/gc_allocator.h"
+
+/* -------------------------------------------------------------------------- */
+
+/* GCConcVector is an append-only vector that many threads can push to and
+ * read from at the same time, without an external lock.
+ *
+ * It uses the same layout as GCSegVector - the first chunk holds
+ * 'first_chunk_cap' elements(a power of two), each next chunk is twice as
+ * big. The chunk directory has a fixed size, so neither the directory nor
+ * the chunks ever move - growing never blocks readers of existing elements.
+ *
+ * 1. push_back reserves a slot with a single atomic increment. If the slot
+ * falls into a chunk that does not exist yet, the chunk is allocated and
+ * installed with a CAS(a thread that loses the race frees its chunk). Chunks
+ * are installed in order - missing lower chunks are installed first.
+ * 2. After the element is written, its slot is marked ready and the
+ * published size is advanced over every ready slot, in slot order. A writer
+ * never waits for another one - if an earlier slot is still being written,
+ * its writer advances the size past the later slots once it is done.
+ * 3. Readers only see published elements: every element below the size
+ * returned by gc_cvec_size() is fully written. The size never decreases.
+ *
+ * Elements can not be removed or modified once pushed. Creating and
+ * destroying the vector is not thread-safe. */
+
+typedef struct GCConcVector* GCConcVector;
+
+/* -------------------------------------------------------------------------- */
+
+/* INTERNAL FUNCTION - use a convenience macro instead.
+ *
+ * Dynamically allocates memory for the struct GCConcVector and initializes
+ * it. The first chunk will hold 'first_chunk_cap' elements, rounded up to a
+ * power of two. No chunks are allocated until the first element is added.
+ *
+ * RETURN VALUES:
+ *   ON SUCCESS: Address of dynamically allocated GCConcVector,
+ *   ON FAILURE: NULL.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_ALLOC_FAIL - Dynamic allocation failed,
+ *   3. GC_ERR_INVALID_ARG - provided 'el_size' or 'first_chunk_cap' is equal
+ *   to 0 or 'first_chunk_cap' is too big. */
+
+GCConcVector _gc_cvec_create(size_t first_chunk_cap, size_t el_size,
+        gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* INTERNAL FUNCTION - use a convenience macro instead.
+ *
+ * Works like _gc_cvec_create(), but every allocation made by the vector goes
+ * through 'allocator'. The allocator must be thread-safe. The vector keeps a
+ * copy of 'allocator'.
+ *
+ * STATUS CODES:
+ *   See _gc_cvec_create(). Additionally, GC_ERR_INVALID_ARG is returned if
+ *   'allocator' is NULL. */
+
+GCConcVector _gc_cvec_create_with(size_t first_chunk_cap, size_t el_size,
+        const struct GCAllocator* allocator, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Destroys the vector and frees all of its chunks. No other thread may be
+ * using the vector.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' is NULL. */
+
+void gc_cvec_destroy(GCConcVector vector, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Gets vector's published size - elements at positions below it can be
+ * read. Assumes that 'vector' is a pointer to a valid vector. */
+
+size_t gc_cvec_size(const GCConcVector vector);
+
+/* -------------------------------------------------------------------------- */
+
+/* INTERNAL FUNCTION - use a convenience macro instead.
+ *
+ * Returns address of published element with position 'pos' inside the
+ * vector. The address stays valid until the vector is destroyed.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: adress of element with position 'pos',
+ *   ON FAILURE: NULL.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' is NULL,
+ *   3. GC_ERR_OUT_OF_BOUNDS - 'pos' is not below the published size. */
+
+void* _gc_cvec_at(const GCConcVector vector, size_t pos,
+        gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* INTERNAL FUNCTION - use a convenience macro instead.
+ *
+ * Appends new element with data 'data' to the end of the vector. Safe to call
+ * from multiple threads at the same time. The element is published as soon
+ * as all elements pushed before it are written - if another thread is still
+ * writing an earlier element, the function returns without waiting and the
+ * element becomes visible a bit later.
+ *
+ * If a chunk allocation fails(and no other thread installs the chunk in the
+ * meantime), the published size stops at the failed slot. This push_back
+ * returns GC_ERR_ALLOC_FAIL, and so does every push_back of a later slot -
+ * including the ones that were already writing their elements when the
+ * allocation failed. An element whose push_back returned GC_SUCCESS is always
+ * published. Elements published before the failure stay readable.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' or 'data' is NULL,
+ *   3. GC_ERR_ALLOC_FAIL - allocation of a new chunk failed. */
+
+void _gc_cvec_push_back(GCConcVector vector, const void* data,
+        gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Allocates chunks until the vector can hold at least 'capacity' elements,
+ * so that later push_backs up to 'capacity' never allocate. Safe to call
+ * concurrently with push_back.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' is NULL,
+ *   3. GC_ERR_ALLOC_FAIL - allocation of a chunk failed. The chunks allocated
+ *   before the failure are kept. */
+
+void gc_cvec_reserve(GCConcVector vector, size_t capacity,
+        gc_status* out_status);
+
+/* CONVENIENCE MACROS ------------------------------------------------------- */
+
+/* Value concurrent vector - stores copies of values inside the vector.
+ * 'type' argument inside some of the macros below refers to the value type
+ * stored inside the vector - if the vector stores ints, it should be 'int'. */
+
+#define gc_cvec_create_val(first_chunk_cap, type, out_status) \
+    _gc_cvec_create((first_chunk_cap), sizeof(type), (out_status))
+
+#define gc_cvec_create_val_with(first_chunk_cap, type, allocator, out_status) \
+    _gc_cvec_create_with((first_chunk_cap), sizeof(type), (allocator),       \
+            (out_status))
+
+#define gc_cvec_at_val(cvec, pos, out_status, type) \
+    (type *)_gc_cvec_at((cvec), (pos), (out_status))
+
+#define gc_cvec_push_back_val(cvec, data, out_status) \
+    _gc_cvec_push_back((cvec), (data), (out_status))
+
+/* -------------------------------------------------------------------------- */
+
+/* Pointer concurrent vector - stores pointers inside the vector. Like with
+ * GCPVector, 'data' refers to a single pointer holding the address of some
+ * data. */
+
+#define gc_cvec_create_ptr(first_chunk_cap, out_status) \
+    _gc_cvec_create((first_chunk_cap), sizeof(void*), (out_status))
+
+#define gc_cvec_create_ptr_with(first_chunk_cap, allocator, out_status) \
+    _gc_cvec_create_with((first_chunk_cap), sizeof(void*), (allocator),   \
+            (out_status))
+
+#define gc_cvec_at_ptr(cvec, pos, out_status, type) \
+    *(type **)_gc_cvec_at((cvec), (pos), (out_status))
+
+#define gc_cvec_push_back_ptr(cvec, data, out_status) \
+    _gc_cvec_push_back((cvec), &(data), (out_status))
+
+#endif // _GC_CONC_VECTOR_H_
@@ -0,0 +1,223 @@
+#ifndef _GC_SEG_VECTOR_H_
+#define _GC_SEG_VECTOR_H_
+
+#include <stdlib.h>
+#include "gc_shared.h"
+#include "alloc/gc_allocator.h"
+
+/* -------------------------------------------------------------------------- */
+
+/* GCSegVector is a segmented vector - its elements are stored in a sequence of
+ * chunks instead of a single block. The first chunk holds 'first_chunk_cap'
+ * elements(a power of two) and each next chunk is twice as big as the
+ * previous one, so the chunks double the vector's capacity just like a
+ * GCVector would. Unlike a GCVector, growing never moves existing elements:
+ *
+ * 1. the address of an element never changes while the element is in the
+ * vector - pointers returned by gc_segvec_at() stay valid until the element
+ * is removed or the vector is destroyed;
+ * 2. growing never copies elements - a new chunk is allocated instead.
+ *
+ * Indexing is O(1): the chunk holding an element is found from the position
+ * of the highest set bit of ('pos' + 'first_chunk_cap').
+ *
+ * The elements are not contiguous, so there is no data field - elements must
+ * be accessed one at a time. */
+
+typedef struct GCSegVector* GCSegVector;
+
+/* -------------------------------------------------------------------------- */
+
+/* INTERNAL FUNCTION - use a convenience macro instead.
+ *
+ * Dynamically allocates memory for the struct GCSegVector and initializes it.
+ * The first chunk will hold 'first_chunk_cap' elements, rounded up to a power
+ * of two. No chunks are allocated until the first element is added.
+ *
+ * RETURN VALUES:
+ *   ON SUCCESS: Address of dynamically allocated GCSegVector,
+ *   ON FAILURE: NULL.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_ALLOC_FAIL - Dynamic allocation failed,
+ *   3. GC_ERR_INVALID_ARG - provided 'el_size' or 'first_chunk_cap' is equal
+ *   to 0 or 'first_chunk_cap' is too big. */
+
+GCSegVector _gc_segvec_create(size_t first_chunk_cap, size_t el_size,
+        gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* INTERNAL FUNCTION - use a convenience macro instead.
+ *
+ * Works like _gc_segvec_create(), but every allocation made by the vector -
+ * the struct GCSegVector itself, its chunk directory and its chunks - goes
+ * through 'allocator'. The vector keeps a copy of 'allocator'.
+ *
+ * STATUS CODES:
+ *   See _gc_segvec_create(). Additionally, GC_ERR_INVALID_ARG is returned if
+ *   'allocator' is NULL. */
+
+GCSegVector _gc_segvec_create_with(size_t first_chunk_cap, size_t el_size,
+        const struct GCAllocator* allocator, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Destroys the vector and frees all of its chunks.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' is NULL. */
+
+void gc_segvec_destroy(GCSegVector vector, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Gets vector's size.
+ * Assumes that 'vector' is a pointer to a valid vector. */
+
+size_t gc_segvec_size(const GCSegVector vector);
+
+/* ------------------------------------------------------ */
+
+/* Gets vector's capacity - the number of elements its allocated chunks can
+ * hold. Assumes that 'vector' is a pointer to a valid vector. */
+
+size_t gc_segvec_capacity(const GCSegVector vector);
+
+/* -------------------------------------------------------------------------- */
+
+/* INTERNAL FUNCTION - use a convenience macro instead.
+ *
+ * Returns address of element with position 'pos' inside the vector. The
+ * address stays valid until the element is removed or the vector is
+ * destroyed.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: adress of element with position 'pos',
+ *   ON FAILURE: NULL.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' is NULL,
+ *   3. GC_ERR_OUT_OF_BOUNDS - 'pos' is out of bounds. */
+
+void* _gc_segvec_at(const GCSegVector vector, size_t pos,
+        gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* INTERNAL FUNCTION - use a convenience macro instead.
+ *
+ * Assigns specified data 'data' to element with position 'pos'.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' or 'data' is NULL,
+ *   3. GC_ERR_OUT_OF_BOUNDS - 'pos' is out of bounds. */
+
+void _gc_segvec_set(GCSegVector vector, const void* data, size_t pos,
+        gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* INTERNAL FUNCTION - use a convenience macro instead.
+ *
+ * Appends new element with data 'data' to the end of the vector. If the last
+ * chunk is full, a new chunk is allocated - existing elements are not moved.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' or 'data' is NULL,
+ *   3. GC_ERR_ALLOC_FAIL - allocation of a new chunk failed. */
+
+void _gc_segvec_push_back(GCSegVector vector, const void* data,
+        gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Appends a new, uninitialized element to the end of the vector and returns
+ * its address, so that the caller can construct the element in place.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: address of the new element,
+ *   ON FAILURE: NULL.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' is NULL,
+ *   3. GC_ERR_ALLOC_FAIL - allocation of a new chunk failed. */
+
+void* gc_segvec_emplace_back(GCSegVector vector, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Removes the last element inside the vector. Chunks are kept for reuse.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' is NULL,
+ *   3. GC_ERR_VECTOR_EMPTY - 'vector' is already empty. */
+
+void gc_segvec_pop_back(GCSegVector vector, gc_status* out_status);
+
+/* -------------------------------------------------------------------------- */
+
+/* Allocates chunks until the vector can hold at least 'capacity' elements.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' is NULL,
+ *   3. GC_ERR_ALLOC_FAIL - allocation of a new chunk failed. The chunks
+ *   allocated before the failure are kept. */
+
+void gc_segvec_reserve(GCSegVector vector, size_t capacity,
+        gc_status* out_status);
+
+/* CONVENIENCE MACROS ------------------------------------------------------- */
+
+/* Value segmented vector - stores copies of values inside the vector.
+ * 'type' argument inside some of the macros below refers to the value type
+ * stored inside the vector - if the vector stores ints, it should be 'int'. */
+
+#define gc_segvec_create_val(first_chunk_cap, type, out_status) \
+    _gc_segvec_create((first_chunk_cap), sizeof(type), (out_status))
+
+#define gc_segvec_create_val_with(first_chunk_cap, type, allocator,          \
+        out_status)                                                            \
+    _gc_segvec_create_with((first_chunk_cap), sizeof(type), (allocator),       \
+            (out_status))
+
+#define gc_segvec_at_val(segvec, pos, out_status, type) \
+    (type *)_gc_segvec_at((segvec), (pos), (out_status))
+
+#define gc_segvec_set_val(segvec, data, pos, out_status) \
+    _gc_segvec_set((segvec), (data), (pos), (out_status))
+
+#define gc_segvec_push_back_val(segvec, data, out_status) \
+    _gc_segvec_push_back((segvec), (data), (out_status))
+
+/* -------------------------------------------------------------------------- */
+
+/* Pointer segmented vector - stores pointers inside the vector. Like with
+ * GCPVector, 'data' refers to a single pointer holding the address of some
+ * data. */
+
+#define gc_segvec_create_ptr(first_chunk_cap, out_status) \
+    _gc_segvec_create((first_chunk_cap), sizeof(void*), (out_status))
+
+#define gc_segvec_create_ptr_with(first_chunk_cap, allocator, out_status) \
+    _gc_segvec_create_with((first_chunk_cap), sizeof(void*), (allocator),   \
+            (out_status))
+
+#define gc_segvec_at_ptr(segvec, pos, out_status, type) \
+    *(type **)_gc_segvec_at((segvec), (pos), (out_status))
+
+#define gc_segvec_set_ptr(segvec, data, pos, out_status) \
+    _gc_segvec_set((segvec), &(data), (pos), (out_status))
+
+#define gc_segvec_push_back_ptr(segvec, data, out_status) \
+    _gc_segvec_push_back((segvec), &(data), (out_status))
+
+#endif // _GC_SEG_VECTOR_H_
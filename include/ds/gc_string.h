@@ -2,6 +2,7 @@
 #define _GC_STRING_H_
 
 #include "gc_shared.h"
+#include "alloc/gc_allocator.h"
 
 #include <stdlib.h>
 #include <stdbool.h>
@@ -53,6 +54,25 @@ GCString gc_str_create_(const char* content, size_t len, gc_status* out_status);
 
 /* ---------------------------------- */
 
+/* Works like gc_str_create_(), but every allocation made by the string - the
+ * underlying struct, the char array and any later resize - goes through
+ * 'allocator'. The string keeps a copy of 'allocator'.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: Address of the newly allocated opaque underlying struct;
+ *   ON FAILURE: NULL.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS: Function call was successful;
+ *   2. GC_ERR_ALLOC_FAIL: 'allocator' failed to allocate memory for internal
+ *   struct _GCString or for the char array;
+ *   3. GC_ERR_INVALID_ARG: 'allocator' is NULL. */
+
+GCString gc_str_create_with(const char* content, size_t len,
+        const struct GCAllocator* allocator, gc_status* out_status);
+
+/* ---------------------------------- */
+
 /* Creates GCString from an existing view. This is done by calling:
  * gc_str_create_(gc_sv_data(sv), gc_sv_len(sv), &_status);
  *
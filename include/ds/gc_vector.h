@@ -3,6 +3,9 @@
 
 #include <stdlib.h>
 #include "gc_shared.h"
+#include "alloc/gc_allocator.h"
+#include "ds/_gc_vector.h"
+#include <string.h>
 
 /* ------------------------------------------------------------------------- */ 
 
@@ -50,6 +53,67 @@ _GCVector _gc_vec_create(size_t capacity, size_t el_size, gc_status* out_status)
 
 /* ------------------------------------------------------ */
 
+/* INTERNAL FUNCTION - use a convenience macro instead.
+ *
+ * Works like _gc_vec_create(), but every allocation made by the vector -
+ * the struct __GCVector itself, its data field and any later resize - goes
+ * through 'allocator'. The vector keeps a copy of 'allocator'.
+ *
+ * RETURN VALUES:
+ *   ON SUCCESS: Address of the newly allocated _GCVector,
+ *   ON FAILURE: NULL.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_ALLOC_FAIL - 'allocator' failed to allocate memory,
+ *   3. GC_ERR_INVALID_ARG - provided 'el_size' or 'capacity' is equal to 0 or
+ *   'allocator' is NULL. */
+
+_GCVector _gc_vec_create_with(size_t capacity, size_t el_size,
+        const struct GCAllocator* allocator, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* INTERNAL FUNCTION - use a convenience macro instead.
+ *
+ * Creates a small-buffer vector - storage for the first 'inline_cap'
+ * elements is placed inside the struct __GCVector itself, so the vector is a
+ * single allocation. Only when the vector grows beyond 'inline_cap' elements
+ * are they moved to a separately allocated data field. If the vector later
+ * shrinks back(gc_vec_fit()), the elements are moved back inline.
+ *
+ * Meant for the common case of short-lived vectors holding a handful of
+ * elements. The returned vector works with every gc_vec_* function.
+ *
+ * RETURN VALUES:
+ *   ON SUCCESS: Address of the newly allocated _GCVector,
+ *   ON FAILURE: NULL.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_ALLOC_FAIL - Dynamic allocation failed,
+ *   3. GC_ERR_INVALID_ARG - provided 'el_size' or 'inline_cap' is equal to 0
+ *   or the vector's size would overflow. */
+
+_GCVector _gc_vec_create_small(size_t inline_cap, size_t el_size,
+        gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* INTERNAL FUNCTION - use a convenience macro instead.
+ *
+ * Works like _gc_vec_create_small(), but the vector allocates through
+ * 'allocator'(see _gc_vec_create_with()).
+ *
+ * STATUS CODES:
+ *   See _gc_vec_create_small(). Additionally, GC_ERR_INVALID_ARG is returned
+ *   if 'allocator' is NULL. */
+
+_GCVector _gc_vec_create_small_with(size_t inline_cap, size_t el_size,
+        const struct GCAllocator* allocator, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
 /* Destroys the vector. Sets its fields to default values. Frees the dynamically
  * allocated memory for the vector and the vector's data field.
  *
@@ -128,6 +192,80 @@ void _gc_vec_insert(_GCVector vector, const void* data, size_t pos,
 
 void _gc_vec_push_back(_GCVector vector, const void* data, gc_status* out_status);
 
+/* ------------------------------------------------------ */
+
+/* Inserts 'count' elements, copied from 'data_arr', at position 'pos'. All
+ * elements right of(including) 'pos' are shifted rightward once, by 'count'
+ * positions. If the vector does not have enough capacity, it is resized once,
+ * to fit all of the new elements. 'data_arr' must hold 'count' elements and
+ * must not point inside the vector. Works the same way for value and pointer
+ * vectors - for a pointer vector, 'data_arr' is an array of pointers.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' is NULL or 'data_arr' is NULL while
+ *   'count' is not 0,
+ *   3. GC_ERR_OUT_OF_BOUNDS - 'pos' is out of bounds,
+ *   4. GC_ERR_ALLOC_FAIL - vector attempted to realloc() for more memory
+ *   and the realloc() call failed. Nothing is inserted. */
+
+void gc_vec_insert_n(_GCVector vector, const void* data_arr, size_t count,
+        size_t pos, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Appends 'count' elements, copied from 'data_arr', to the end of the vector.
+ * See gc_vec_insert_n().
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' is NULL or 'data_arr' is NULL while
+ *   'count' is not 0,
+ *   3. GC_ERR_ALLOC_FAIL - vector attempted to realloc() for more memory
+ *   and the realloc() call failed. Nothing is appended. */
+
+void gc_vec_append_n(_GCVector vector, const void* data_arr, size_t count,
+        gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Inserts a new, uninitialized element at position 'pos' and returns its
+ * address, so that the caller can construct the element in place instead of
+ * building it elsewhere and copying it in. All elements right of(including)
+ * 'pos' are shifted rightward. If the vector is at max capacity, it will
+ * attempt to resize(via realloc()). The address is valid until the vector is
+ * modified.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: address of the new element,
+ *   ON FAILURE: NULL.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' is NULL,
+ *   3. GC_ERR_OUT_OF_BOUNDS - 'pos' is out of bounds,
+ *   4. GC_ERR_ALLOC_FAIL - vector attempted to realloc() for more memory
+ *   and the realloc() call failed. */
+
+void* gc_vec_emplace_at(_GCVector vector, size_t pos, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Appends a new, uninitialized element to the end of the vector and returns
+ * its address. See gc_vec_emplace_at().
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: address of the new element,
+ *   ON FAILURE: NULL.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' is NULL,
+ *   3. GC_ERR_ALLOC_FAIL - vector attempted to realloc() for more memory
+ *   and the realloc() call failed. */
+
+void* gc_vec_emplace_back(_GCVector vector, gc_status* out_status);
+
 /* -------------------------------------------------------------------------- */
 
 /* Removes element with position 'pos' from the vector. This causes all elements
@@ -142,6 +280,33 @@ void gc_vec_remove(_GCVector vector, size_t pos, gc_status* out_status);
 
 /* ------------------------------------------------------ */
 
+/* Removes elements with positions in range ['start_pos', 'end_pos') from the
+ * vector. All elements right of the range are shifted leftward once.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' is NULL,
+ *   3. GC_ERR_OUT_OF_BOUNDS - 'start_pos' > 'end_pos' or 'end_pos' is greater
+ *   than the vector's size. */
+
+void gc_vec_remove_range(_GCVector vector, size_t start_pos, size_t end_pos,
+        gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
+/* Removes element with position 'pos' from the vector in O(1) - the last
+ * element is moved into its place. Unlike gc_vec_remove(), this does not
+ * preserve the order of the elements.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_INVALID_ARG - 'vector' is NULL,
+ *   3. GC_ERR_OUT_OF_BOUNDS - 'pos' is out of bounds. */
+
+void gc_vec_swap_remove(_GCVector vector, size_t pos, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
 /* Removes the last element inside the vector.
  * STATUS CODES:
  *   1. GC_SUCCESS - Function call was successful,
@@ -177,6 +342,67 @@ void gc_vec_reserve(_GCVector vector, size_t capacity, gc_status* out_status);
 
 void gc_vec_fit(_GCVector vector, gc_status* out_status);
 
+/* UNCHECKED ACCESSORS ------------------------------------------------------ */
+
+/* The following functions are defined in the header, so that the compiler
+ * can inline them into tight loops. They do not check their arguments -
+ * every assumption listed must be checked by the caller. Breaking one of them
+ * is undefined behavior. */
+
+/* Assumptions:
+ * 1. 'vector' is a valid _GCVector. */
+static inline size_t gc_vec_size_unchecked(const _GCVector vector)
+{
+    return vector->_base._size;
+}
+
+/* Assumptions:
+ * 1. 'vector' is a valid _GCVector,
+ * 2. 'pos' < vector's size. */
+static inline void* _gc_vec_at_unchecked(const _GCVector vector, size_t pos)
+{
+    return (char*)vector->_base._data + (pos * vector->_base._el_size);
+}
+
+/* Assumptions:
+ * 1. 'vector' is a valid _GCVector,
+ * 2. 'pos' < vector's size,
+ * 3. 'data' points to an element-sized value. */
+static inline void _gc_vec_set_unchecked(_GCVector vector, const void* data,
+        size_t pos)
+{
+    memcpy(_gc_vec_at_unchecked(vector, pos), data, vector->_base._el_size);
+}
+
+/* Assumptions:
+ * 1. 'vector' is a valid _GCVector,
+ * 2. 'data' points to an element-sized value, not inside the vector.
+ *
+ * Appends the element in place if the vector has spare capacity. Otherwise,
+ * falls back to _gc_vec_push_back(), which grows the vector.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS - Function call was successful,
+ *   2. GC_ERR_ALLOC_FAIL - vector attempted to realloc() for more memory
+ *   and the realloc() call failed. */
+static inline void _gc_vec_push_back_unchecked(_GCVector vector,
+        const void* data, gc_status* out_status)
+{
+    struct __GCArray* base = &vector->_base;
+
+    if(base->_size == base->_capacity)
+    {
+        _gc_vec_push_back(vector, data, out_status);
+        return;
+    }
+
+    memcpy((char*)base->_data + (base->_size * base->_el_size), data,
+            base->_el_size);
+    base->_size++;
+
+    if(out_status != NULL) *out_status = GC_SUCCESS;
+}
+
 /* CONVENIENCE MACROS ------------------------------------------------------- */
 
 /* 'type' refers to the data type stored inside the vector */
@@ -197,6 +423,16 @@ typedef _GCVector GCVVector;
 #define gc_vec_create_val(init_cap, type, out_status) \
     _gc_vec_create((init_cap), sizeof(type), (out_status))
 
+#define gc_vec_create_val_with(init_cap, type, allocator, out_status) \
+    _gc_vec_create_with((init_cap), sizeof(type), (allocator), (out_status))
+
+#define gc_vec_create_val_small(inline_cap, type, out_status) \
+    _gc_vec_create_small((inline_cap), sizeof(type), (out_status))
+
+#define gc_vec_create_val_small_with(inline_cap, type, allocator, out_status) \
+    _gc_vec_create_small_with((inline_cap), sizeof(type), (allocator),        \
+            (out_status))
+
 /* Returns pointer to the element inside the vector and peforms a cast to the
  * specified type 'type'. */
 #define gc_vec_at_val(vvector, pos, out_status, type) \
@@ -211,6 +447,16 @@ typedef _GCVector GCVVector;
 #define gc_vec_push_back_val(vvector, data, out_status) \
     _gc_vec_push_back((vvector), (data), (out_status))
 
+/* Unchecked variants - see UNCHECKED ACCESSORS above. */
+#define gc_vec_at_val_unchecked(vvector, pos, type) \
+    (type *)_gc_vec_at_unchecked((vvector), (pos))
+
+#define gc_vec_set_val_unchecked(vvector, data, pos) \
+    _gc_vec_set_unchecked((vvector), (data), (pos))
+
+#define gc_vec_push_back_val_unchecked(vvector, data, out_status) \
+    _gc_vec_push_back_unchecked((vvector), (data), (out_status))
+
 /* -------------------------------------------------------------------------- */
 
 /* Pointer vector - stores pointers inside the vector.
@@ -231,6 +477,16 @@ typedef _GCVector GCPVector;
 #define gc_vec_create_ptr(init_cap, out_status) \
     _gc_vec_create((init_cap), sizeof(void*), (out_status))
 
+#define gc_vec_create_ptr_with(init_cap, allocator, out_status) \
+    _gc_vec_create_with((init_cap), sizeof(void*), (allocator), (out_status))
+
+#define gc_vec_create_ptr_small(inline_cap, out_status) \
+    _gc_vec_create_small((inline_cap), sizeof(void*), (out_status))
+
+#define gc_vec_create_ptr_small_with(inline_cap, allocator, out_status) \
+    _gc_vec_create_small_with((inline_cap), sizeof(void*), (allocator),       \
+            (out_status))
+
 /* Finds the address of element inside the vector with position 'pos'.
  * This is a double pointer, because the element itself is a pointer.
  * It casts this double pointer to the appropriate type. Then, the
@@ -249,4 +505,139 @@ typedef _GCVector GCPVector;
 #define gc_vec_push_back_ptr(vec, data, out_status) \
     _gc_vec_push_back((vec), &(data), (out_status))
 
+/* Unchecked variants - see UNCHECKED ACCESSORS above. */
+#define gc_vec_at_ptr_unchecked(vec, pos, type) \
+    *(type **)_gc_vec_at_unchecked((vec), (pos))
+
+#define gc_vec_set_ptr_unchecked(vec, data, pos) \
+    _gc_vec_set_unchecked((vec), &(data), (pos))
+
+#define gc_vec_push_back_ptr_unchecked(vec, data, out_status) \
+    _gc_vec_push_back_unchecked((vec), &(data), (out_status))
+
+/* TYPED VECTORS ------------------------------------------------------------ */
+
+/* GC_VEC_DEFINE(name, type) generates a vector type 'name' that stores
+ * elements of type 'type', together with static inline functions prefixed
+ * with 'name_'. The element size is known at compile time, so elements are
+ * read and written with plain assignments instead of variable-size copies.
+ * For example:
+ *
+ * GC_VEC_DEFINE(IntVec, int)
+ *
+ * IntVec vec = IntVec_create(16, NULL);
+ * IntVec_push_back(vec, 5, NULL);
+ * int first = IntVec_at(vec, 0);
+ * IntVec_destroy(vec, NULL);
+ *
+ * A typed vector is a GCVector - it is created, grown and destroyed by the
+ * functions above, and name_vector() returns it as a _GCVector, for use with
+ * the rest of the API.
+ *
+ * Generated functions:
+ *   name name_create(size_t capacity, gc_status* out_status);
+ *   name name_create_with(size_t capacity, const struct GCAllocator* allocator,
+ *          gc_status* out_status);
+ *   void name_destroy(name vec, gc_status* out_status);
+ *   _GCVector name_vector(name vec);
+ *   size_t name_size(const name vec);
+ *   size_t name_capacity(const name vec);
+ *   type* name_data(const name vec);
+ *   type name_at(const name vec, size_t pos);
+ *   type* name_at_ptr(const name vec, size_t pos);
+ *   void name_set(name vec, size_t pos, type value);
+ *   void name_push_back(name vec, type value, gc_status* out_status);
+ *   void name_pop_back(name vec, gc_status* out_status);
+ *   void name_reserve(name vec, size_t capacity, gc_status* out_status);
+ *
+ * name_at(), name_at_ptr() and name_set() are unchecked - 'vec' must be valid
+ * and 'pos' must be less than the vector's size. name_push_back() assumes
+ * that 'vec' is valid; it grows the vector like _gc_vec_push_back(). The rest
+ * of the functions work like their gc_vec_* counterparts. */
+
+#define GC_VEC_DEFINE(name, type)                                              \
+                                                                               \
+typedef struct name##_ { struct __GCVector _base; }* name;                     \
+                                                                               \
+static inline name name##_create(size_t capacity, gc_status* out_status)       \
+{                                                                              \
+    return (name)_gc_vec_create(capacity, sizeof(type), out_status);           \
+}                                                                              \
+                                                                               \
+static inline name name##_create_with(size_t capacity,                         \
+        const struct GCAllocator* allocator, gc_status* out_status)            \
+{                                                                              \
+    return (name)_gc_vec_create_with(capacity, sizeof(type), allocator,        \
+            out_status);                                                       \
+}                                                                              \
+                                                                               \
+static inline void name##_destroy(name vec, gc_status* out_status)             \
+{                                                                              \
+    gc_vec_destroy((_GCVector)vec, out_status);                                \
+}                                                                              \
+                                                                               \
+static inline _GCVector name##_vector(name vec)                                \
+{                                                                              \
+    return (_GCVector)vec;                                                     \
+}                                                                              \
+                                                                               \
+static inline size_t name##_size(const name vec)                               \
+{                                                                              \
+    return vec->_base._base._size;                                             \
+}                                                                              \
+                                                                               \
+static inline size_t name##_capacity(const name vec)                           \
+{                                                                              \
+    return vec->_base._base._capacity;                                         \
+}                                                                              \
+                                                                               \
+static inline type* name##_data(const name vec)                                \
+{                                                                              \
+    return (type*)vec->_base._base._data;                                      \
+}                                                                              \
+                                                                               \
+static inline type name##_at(const name vec, size_t pos)                       \
+{                                                                              \
+    return ((type*)vec->_base._base._data)[pos];                               \
+}                                                                              \
+                                                                               \
+static inline type* name##_at_ptr(const name vec, size_t pos)                  \
+{                                                                              \
+    return (type*)vec->_base._base._data + pos;                                \
+}                                                                              \
+                                                                               \
+static inline void name##_set(name vec, size_t pos, type value)                \
+{                                                                              \
+    ((type*)vec->_base._base._data)[pos] = value;                              \
+}                                                                              \
+                                                                               \
+static inline void name##_push_back(name vec, type value,                      \
+        gc_status* out_status)                                                 \
+{                                                                              \
+    struct __GCArray* base = &vec->_base._base;                                \
+                                                                               \
+    if(base->_size == base->_capacity)                                         \
+    {                                                                          \
+        _gc_vec_push_back((_GCVector)vec, &value, out_status);                 \
+        return;                                                                \
+    }                                                                          \
+                                                                               \
+    ((type*)base->_data)[base->_size++] = value;                               \
+                                                                               \
+    if(out_status != NULL) *out_status = GC_SUCCESS;                           \
+}                                                                              \
+                                                                               \
+static inline void name##_pop_back(name vec, gc_status* out_status)            \
+{                                                                              \
+    gc_vec_pop_back((_GCVector)vec, out_status);                               \
+}                                                                              \
+                                                                               \
+static inline void name##_reserve(name vec, size_t capacity,                   \
+        gc_status* out_status)                                                 \
+{                                                                              \
+    gc_vec_reserve((_GCVector)vec, capacity, out_status);                      \
+}
+
+/* -------------------------------------------------------------------------- */
+
 #endif // _GC_VECTOR_H_
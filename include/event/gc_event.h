@@ -2,6 +2,7 @@
 #define _GC_EVENT_H_
 
 #include "gc_shared.h"
+#include "alloc/gc_allocator.h"
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -64,6 +65,24 @@ GCEvent gc_event_create(GCEventParticipant source, gc_status* out_status);
 
 /* ------------------------------------------------------ */
 
+/* Works like gc_event_create(), but the underlying struct and the internal
+ * subscriber vector are allocated through 'allocator'. The event keeps a copy
+ * of 'allocator'.
+ *
+ * RETURN VALUE:
+ *   ON SUCCESS: address of the newly allocated opaque struct;
+ *   ON FAILURE: NULL.
+ *
+ * STATUS CODES:
+ *   1. GC_SUCCESS: Function call was successful;
+ *   2. GC_ERR_ALLOC_FAIL: 'allocator' failed to allocate memory;
+ *   3. GC_ERR_INVALID_ARG: 'source' or 'allocator' is NULL. */
+
+GCEvent gc_event_create_with(GCEventParticipant source,
+        const struct GCAllocator* allocator, gc_status* out_status);
+
+/* ------------------------------------------------------ */
+
 /* Frees the dynamically allocated memory for the GCEvent and its fields.
  *
  * STATUS CODES:
@@ -97,6 +116,11 @@ void gc_event_subscribe(GCEvent event, struct GCEventSubscription subscription,
  * removing the appropriate GCEventSubscription from the GCEvent's
  * internal vector.
  *
+ * The subscription is removed in O(1), by moving the last subscription into
+ * its place. This means that unsubscribing changes the order in which the
+ * remaining subscribers are notified by gc_event_raise() - the most recent
+ * subscriber takes the removed subscriber's place.
+ *
  * STATUS CODES:
  *   1. GC_SUCCESS: Function call was successful,
  *   2. GC_ERR_INVALID_ARG: 'event' is NULL or 'subscriber' is NULL,
@@ -31,6 +31,11 @@ typedef int gc_status;
 
 // GCArena
 
+#define GC_ERR_ARENA_STALE_MARK 501
+#define GC_ERR_ARENA_IO 502
+#define GC_ERR_ARENA_BAD_IMAGE 503
+#define GC_ERR_ARENA_IMAGE_VERSION 504
+
 // GCEvent
 
 #define GC_ERR_EVENT_ALR_SUB 601
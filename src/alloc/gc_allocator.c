@@ -0,0 +1,40 @@
+#include "alloc/gc_allocator.h"
+
+#include <stdlib.h>
+
+static void* _default_alloc(size_t size, void* context)
+{
+    return malloc(size);
+}
+
+static void* _default_realloc(void* ptr, size_t old_size, size_t new_size,
+        void* context)
+{
+    return realloc(ptr, new_size);
+}
+
+static void _default_free(void* ptr, size_t size, void* context)
+{
+    free(ptr);
+}
+
+/* -------------------------------------------------------------------------- */
+
+struct GCAllocator gc_allocator_default(void)
+{
+    struct GCAllocator allocator = {
+        .alloc = _default_alloc,
+        .realloc = _default_realloc,
+        .free = _default_free,
+        .context = NULL
+    };
+
+    return allocator;
+}
+
+bool gc_allocator_is_default(const struct GCAllocator* allocator)
+{
+    return (allocator != NULL) && (allocator->alloc == _default_alloc) &&
+        (allocator->realloc == _default_realloc) &&
+        (allocator->free == _default_free);
+}
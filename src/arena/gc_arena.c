@@ -1,31 +1,150 @@
 #include "arena/gc_arena.h"
 
 #include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "_gc_shared.h"
 
-#define ARENA_LOCK(arena) pthread_mutex_lock(&arena->_lock)
-#define ARENA_UNLOCK(arena) pthread_mutex_unlock(&arena->_lock)
+/* Memory pools come from malloc(), so they are aligned at least this much. */
+#define ARENA_DEFAULT_ALIGN _Alignof(max_align_t)
+
+/* Rounds 'size' up to a multiple of 'align'(a power of two). */
+#define ARENA_ALIGN_UP(size, align) (((size) + ((align) - 1)) & ~((align) - 1))
+
+/* Worst-case padding needed to align an allocation at the start of a fresh
+ * memory pool. */
+#define ARENA_POOL_PADDING(align) \
+    (((align) > ARENA_DEFAULT_ALIGN) ? ((align) - ARENA_DEFAULT_ALIGN) : 0)
+
+/* Free-space bins(see GCArena::_bins). Regions with less free space than
+ * ARENA_BIN_MIN_FREE are not binned. At most ARENA_BIN_SCAN regions are
+ * examined per bin when looking for space. */
+#define ARENA_BIN_COUNT (sizeof(size_t) * 8)
+#define ARENA_BIN_MIN_FREE 32
+#define ARENA_BIN_SCAN 8
+
+/* Region cache(see GCArena::_cache). At most ARENA_CACHE_MAX regions are
+ * cached; a cached region not reused within ARENA_CACHE_DECAY cycles is freed.
+ * A cached region is only reused for a request at least 1/ARENA_CACHE_FIT
+ * of its size. */
+#define ARENA_CACHE_MAX 8
+#define ARENA_CACHE_DECAY 4
+#define ARENA_CACHE_FIT 2
+
+/* File-backed arenas(see gc_arena_create_file()). An image starts with a
+ * struct ArenaImageHeader, padded to ARENA_IMAGE_HEADER bytes; the memory
+ * pool of the arena's only region follows. Offsets are relative to the start
+ * of the image, so offset 0(the header) never refers to an allocation. */
+#define ARENA_IMAGE_MAGIC "GCARENA"
+#define ARENA_IMAGE_VERSION 1
+#define ARENA_IMAGE_BYTE_ORDER 0x01020304
+#define ARENA_IMAGE_HEADER 64
+
+struct ArenaImageHeader
+{
+    char _magic[8];
+    uint32_t _version;
+
+    /* ARENA_IMAGE_BYTE_ORDER, as stored by the machine that wrote the image. */
+    uint32_t _byte_order;
+
+    /* Size of the whole image(the file), header included. */
+    uint64_t _size;
+
+    /* Bytes used in the memory pool. */
+    uint64_t _used;
+
+    /* Offset of the root object, 0 if none. */
+    uint64_t _root;
+};
+
+_Static_assert(sizeof(struct ArenaImageHeader) <= ARENA_IMAGE_HEADER,
+        "ArenaImageHeader does not fit inside ARENA_IMAGE_HEADER");
+
+/* Any of these flags makes the arena map its memory pools with mmap(). */
+#define ARENA_MMAP_FLAGS \
+    (GC_ARENA_MMAP | GC_ARENA_HUGEPAGES | GC_ARENA_POPULATE)
+
+/* GC_ARENA_SINGLE_THREAD arenas never take their lock. */
+#define ARENA_SYNCED(arena) \
+    (!((arena)->_options.flags & GC_ARENA_SINGLE_THREAD))
+
+/* Unless compiled with GC_ARENA_NO_STATS, lock acquisitions are counted
+ * (see gc_arena_stats()). */
+#ifdef GC_ARENA_NO_STATS
+#define ARENA_LOCK(arena) \
+    do { if(ARENA_SYNCED(arena)) pthread_mutex_lock(&arena->_lock); } while(0)
+#else
+#define ARENA_LOCK(arena) \
+    do { if(ARENA_SYNCED(arena)) _arena_lock(arena); } while(0)
+#endif
+#define ARENA_UNLOCK(arena) \
+    do { if(ARENA_SYNCED(arena)) pthread_mutex_unlock(&arena->_lock); } while(0)
 
 /* -------------------------------------------------------------------------- */
 
 typedef struct Region Region;
 typedef struct RegionList RegionList;
 
+/* A region is a single allocation - the Region header is placed at the start
+ * of the block, followed by the memory pool. */
 struct Region
 {
-    size_t _used_cap;
+    /* Atomic because GC_ARENA_ATOMIC arenas advance it with a CAS, outside
+     * of the arena's lock. Everywhere else it is accessed under the lock,
+     * through REGION_USED()/REGION_SET_USED(). */
+    _Atomic size_t _used_cap;
     size_t _total_cap;
     char* _mem_pool;
 
+    /* Size of the mapping(header included) if the region was mapped with
+     * mmap()(GC_ARENA_MMAP), 0 if it was allocated with malloc(). */
+    size_t _map_size;
+
+    /* Large regions only - value of the arena's '_large_seq' when the region
+     * was last handed out. Used to release large allocations made after a
+     * GCArenaMark. */
+    uint64_t _seq;
+
+    /* Cached regions only - value of the arena's '_cycle' when the region
+     * was put into the cache. */
+    uint64_t _cached_cycle;
+
+    /* Free-space bin the region is in(see GCArena::_bins), -1 if none. */
+    int _bin;
+    Region* _bin_prev;
+    Region* _bin_next;
+
     Region* _next;
 };
 
-static Region* _region_alloc(size_t total_cap);
+/* Relaxed access to a region's '_used_cap', for code holding the arena's lock.
+ * A plain access to the _Atomic field would be sequentially consistent. */
+#define REGION_USED(region)                                                    \
+    atomic_load_explicit(&(region)->_used_cap, memory_order_relaxed)
+#define REGION_SET_USED(region, used)                                          \
+    atomic_store_explicit(&(region)->_used_cap, (used), memory_order_relaxed)
+
+/* Size of the Region header, padded so that the memory pool following it is
+ * aligned to ARENA_DEFAULT_ALIGN. */
+#define ARENA_REGION_HEADER \
+    ((sizeof(Region) + ARENA_DEFAULT_ALIGN - 1) & ~(ARENA_DEFAULT_ALIGN - 1))
+
+static Region* _region_alloc(size_t total_cap, int flags);
+static Region* _region_wrap(char* mem_pool, size_t total_cap);
 static void _region_destroy(Region* region);
+static char* _region_map(size_t size, int flags, size_t* out_map_size);
+static void _region_trim(Region* region);
 
 /* -------------------------------------------------------------------------- */
 
@@ -38,9 +157,11 @@ struct RegionList
 };
 
 static void _region_list_init(RegionList* list);
-static void _region_list_push_back(RegionList* list, size_t total_cap,
-        gc_status* out_status);
-static void _region_list_pop_front(RegionList* list);
+static void _region_list_append(RegionList* list, Region* region);
+static void _region_list_remove(RegionList* list, Region* prev,
+        Region* region);
+static Region* _region_list_pop_front(RegionList* list);
+static Region* _region_list_truncate(RegionList* list);
 
 /* -------------------------------------------------------------------------- */
 /* -------------------------------------------------------------------------- */
@@ -51,45 +172,331 @@ struct GCArena
     RegionList _regions;
     size_t _region_cap;
 
+    /* Regions never grow beyond this(see GCArenaOptions). Equal to
+     * '_region_cap' for GC_ARENA_GROWTH_FIXED. */
+    size_t _max_region_cap;
+
+    /* Side list of regions serving allocations that do not fit inside a
+     * region. Each large region holds a single allocation. */
+    RegionList _large;
+
+    /* Regions the allocator has moved on from, while they still had free
+     * space left(GC_ARENA_ATOMIC arenas excluded). Segregated by the amount
+     * of free space - bin 'i' holds regions with [2^i, 2^(i+1)) free bytes.
+     * Allocations that do not fit inside the active region are served from
+     * these regions first. */
+    Region* _bins[ARENA_BIN_COUNT];
+
+    /* Bit 'i' is set if bin 'i' is not empty. */
+    uint64_t _bin_mask;
+
+    /* Regions released by gc_arena_reset()(or replaced by the adaptive growth
+     * policy), kept for reuse so that reset/refill cycles do not go back to
+     * the system allocator. Oldest first. */
+    RegionList _cache;
+
+    /* Incremented on every large allocation. */
+    uint64_t _large_seq;
+
+    /* Incremented on every rewind/reset. GCArenaMarks from older cycles are
+     * stale. */
+    uint64_t _cycle;
+
+    /* Counters only - the rest of the fields are computed by
+     * gc_arena_stats(). Modified under the lock. */
+    struct GCArenaStats _stats;
+
     Region* _rewind_it;
 
+    /* Region currently being allocated from - the tail, or '_rewind_it' while
+     * rewinding. Only written under the lock; read without it by
+     * GC_ARENA_ATOMIC allocations. */
+    _Atomic(Region*) _active;
+
+    struct GCArenaOptions _options;
+
+    /* Changes on every rewind/reset. Thread chunks taken in an older epoch
+     * are no longer valid. */
+    _Atomic uint64_t _epoch;
+
+    /* File-backed arenas only - mapping of the whole image, NULL otherwise.
+     * The arena's only region lives inside the mapping and the arena never
+     * grows beyond it. */
+    char* _image;
+    size_t _image_size;
+    bool _image_readonly;
+
     pthread_mutex_t _lock;
 };
 
-static Region* _region_alloc(size_t total_cap)
+static inline void _arena_lock(GCArena arena)
 {
-    Region* new = (Region*)malloc(sizeof(Region));
+    if(pthread_mutex_trylock(&arena->_lock) != 0)
+    {
+        pthread_mutex_lock(&arena->_lock);
+        arena->_stats.lock_contentions++;
+    }
 
-    if(new == NULL) return NULL;
+    arena->_stats.lock_acquisitions++;
+}
 
-    new->_next = NULL;
-    new->_total_cap = 0;
-    new->_used_cap = 0;
+/* -------------------------------------------------------------------------- */
+
+/* Per-thread chunks(GC_ARENA_THREAD_CACHE). Each thread has a small table of
+ * chunks - one slot per arena. An arena is looked up starting at its home
+ * slot and probing the rest of the table, so arenas whose home slots collide
+ * do not evict each other. A slot is only taken from another arena once all
+ * slots are in use(more than THREAD_CACHE_SLOTS arenas used by one thread),
+ * in round-robin order. A chunk is valid only if both the arena and the
+ * arena's epoch match. Epochs are unique across all arenas, so a destroyed
+ * arena's chunk can never match a new arena created at the same address. */
+
+#define DEFAULT_GROWTH_FACTOR 2.0
+#define DEFAULT_MAX_REGION_FACTOR 64
+#define ADAPTIVE_HEADROOM_DIV 4
+
+#define THREAD_CACHE_SLOTS 8
+#define THREAD_CACHE_DEFAULT_DIV 8
+
+struct ThreadCache
+{
+    GCArena _arena;
+    uint64_t _epoch;
+
+    char* _pos;
+    char* _end;
+};
+
+static _Thread_local struct ThreadCache _thread_caches[THREAD_CACHE_SLOTS];
+
+/* Next slot to take from another arena when the table is full. */
+static _Thread_local size_t _thread_cache_victim;
+
+/* 0 is never handed out, so a zero-initialized ThreadCache is never valid. */
+static _Atomic uint64_t _epoch_counter = 1;
+
+#define THREAD_CACHE_HOME(arena) \
+    (((uintptr_t)(arena) >> 4) % THREAD_CACHE_SLOTS)
+
+/* Probes the slots after the home slot of 'arena'. A found slot is swapped
+ * with the home slot, so the arena used last is found without probing. Kept
+ * out of line, so that the allocation fast path stays small. */
+__attribute__((noinline))
+static struct ThreadCache* _thread_cache_probe(GCArena arena, uint64_t epoch)
+{
+    size_t home = THREAD_CACHE_HOME(arena);
+
+    size_t i;
+    for(i = 1; i < THREAD_CACHE_SLOTS; i++)
+    {
+        struct ThreadCache* cache =
+            &_thread_caches[(home + i) % THREAD_CACHE_SLOTS];
+
+        if(cache->_arena == arena)
+        {
+            struct ThreadCache tmp = _thread_caches[home];
+            _thread_caches[home] = *cache;
+            *cache = tmp;
+
+            cache = &_thread_caches[home];
+
+            return (cache->_epoch == epoch) ? cache : NULL;
+        }
+    }
+
+    return NULL;
+}
+
+/* Returns the calling thread's slot holding a valid chunk of 'arena', or NULL
+ * if there is none. The home slot is checked inline, the others are probed
+ * only if it belongs to another arena. */
+static inline struct ThreadCache* _thread_cache_find(GCArena arena,
+        uint64_t epoch)
+{
+    struct ThreadCache* cache = &_thread_caches[THREAD_CACHE_HOME(arena)];
+
+    if(cache->_arena == arena)
+        return (cache->_epoch == epoch) ? cache : NULL;
+
+    return _thread_cache_probe(arena, epoch);
+}
+
+/* Returns the slot a new chunk of 'arena' should be stored in - the arena's
+ * own slot(holding a stale chunk), a free slot or, if the table is full,
+ * another arena's slot. */
+static struct ThreadCache* _thread_cache_slot(GCArena arena)
+{
+    size_t home = THREAD_CACHE_HOME(arena);
+    struct ThreadCache* free_slot = NULL;
+
+    size_t i;
+    for(i = 0; i < THREAD_CACHE_SLOTS; i++)
+    {
+        struct ThreadCache* cache =
+            &_thread_caches[(home + i) % THREAD_CACHE_SLOTS];
+
+        if(cache->_arena == arena) return cache;
+
+        if((cache->_arena == NULL) && (free_slot == NULL))
+            free_slot = cache;
+    }
 
-    new->_mem_pool = malloc(total_cap);
+    if(free_slot != NULL) return free_slot;
 
-    if(new->_mem_pool == NULL)
+    _thread_cache_victim = (_thread_cache_victim + 1) % THREAD_CACHE_SLOTS;
+
+    return &_thread_caches[_thread_cache_victim];
+}
+
+/* Frees the calling thread's slot of 'arena', if it has one. */
+static void _thread_cache_forget(GCArena arena)
+{
+    size_t i;
+    for(i = 0; i < THREAD_CACHE_SLOTS; i++)
     {
-        free(new);
-        return NULL;
+        if(_thread_caches[i]._arena == arena)
+            _thread_caches[i] = (struct ThreadCache) {0};
     }
+}
+
+/* Checks whether an allocation may not fit inside a fresh region and must be
+ * served from a large region instead. */
+static inline bool _arena_is_large(GCArena arena, size_t size, size_t align)
+{
+    size_t padding = ARENA_POOL_PADDING(align);
+
+    return (padding >= arena->_max_region_cap) ||
+        (size > arena->_max_region_cap - padding);
+}
+
+static void _arena_next_epoch(GCArena arena)
+{
+    atomic_store_explicit(&arena->_epoch,
+            atomic_fetch_add(&_epoch_counter, 1), memory_order_release);
+}
+
+static Region* _region_alloc(size_t total_cap, int flags)
+{
+    if(total_cap > SIZE_MAX - ARENA_REGION_HEADER) return NULL;
+
+    size_t block_size = ARENA_REGION_HEADER + total_cap;
+    size_t map_size = 0;
+
+    Region* new;
+    if(flags & ARENA_MMAP_FLAGS)
+        new = (Region*)_region_map(block_size, flags, &map_size);
+    else
+        new = (Region*)malloc(block_size);
+
+    if(new == NULL) return NULL;
+
+    new->_next = NULL;
+    REGION_SET_USED(new, 0);
+    new->_mem_pool = (char*)new + ARENA_REGION_HEADER;
+    new->_map_size = map_size;
+    new->_seq = 0;
+    new->_cached_cycle = 0;
+    new->_bin = -1;
+    new->_bin_prev = NULL;
+    new->_bin_next = NULL;
+
+    // the rest of the last page is usable as well
+    new->_total_cap = (map_size > 0) ? (map_size - ARENA_REGION_HEADER) :
+        total_cap;
+
+    return new;
+}
+
+/* Creates a region for a memory pool that is not owned by the region(the
+ * pool of a file-backed arena). Only the header is allocated - destroying the
+ * region does not touch the pool. */
+static Region* _region_wrap(char* mem_pool, size_t total_cap)
+{
+    Region* new = (Region*)malloc(sizeof(Region));
+
+    if(new == NULL) return NULL;
 
+    new->_next = NULL;
+    REGION_SET_USED(new, 0);
     new->_total_cap = total_cap;
+    new->_mem_pool = mem_pool;
+    new->_map_size = 0;
+    new->_seq = 0;
+    new->_cached_cycle = 0;
+    new->_bin = -1;
+    new->_bin_prev = NULL;
+    new->_bin_next = NULL;
 
     return new;
 }
 
 static void _region_destroy(Region* region)
 {
-    region->_next = NULL;
-    region->_total_cap = 0;
-    region->_used_cap = 0;
+    if(region->_map_size > 0)
+        munmap(region, region->_map_size);
+    else
+        free(region);
+}
+
+/* Maps an anonymous memory pool of at least 'size' bytes. Stores the actual
+ * size of the mapping(a multiple of the page size) in 'out_map_size'. */
+static char* _region_map(size_t size, int flags, size_t* out_map_size)
+{
+    size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    if(size > SIZE_MAX - (page_size - 1)) return NULL;
+
+    size_t map_size = (size + page_size - 1) & ~(page_size - 1);
+
+    int map_flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_POPULATE
+    if(flags & GC_ARENA_POPULATE) map_flags |= MAP_POPULATE;
+#endif
+
+    void* pool = mmap(NULL, map_size, PROT_READ | PROT_WRITE, map_flags, -1, 0);
+    if(pool == MAP_FAILED) return NULL;
+
+#ifdef MADV_HUGEPAGE
+    // only a hint - failure is not an error
+    if(flags & GC_ARENA_HUGEPAGES) madvise(pool, map_size, MADV_HUGEPAGE);
+#endif
+
+    *out_map_size = map_size;
+
+    return pool;
+}
+
+/* Returns the physical memory backing 'region's memory pool to the system,
+ * while keeping the mapping. Only possible for mapped regions. The first page
+ * holds the header, so it is kept. */
+static void _region_trim(Region* region)
+{
+    if(region->_map_size == 0) return;
 
-    if(region->_mem_pool != NULL) 
-        free(region->_mem_pool);
-    region->_mem_pool = NULL;
+    uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = ((uintptr_t)region->_mem_pool + page_size - 1) &
+        ~(page_size - 1);
+    uintptr_t end = (uintptr_t)region + region->_map_size;
 
-    free(region);
+    if(start < end) madvise((void*)start, end - start, MADV_DONTNEED);
+}
+
+/* Returns the offset inside 'region's memory pool at which an allocation
+ * aligned to 'align' can start, if 'used' bytes of the pool are taken.
+ * 'align' must be a power of two. */
+static inline size_t _region_align_offset(const Region* region, size_t used,
+        size_t align)
+{
+    uintptr_t addr = (uintptr_t)(region->_mem_pool + used);
+
+    return used + ((align - (addr & (align - 1))) & (align - 1));
+}
+
+/* Checks whether 'size' bytes starting at 'offset' fit inside 'region'. */
+static inline bool _region_fits(const Region* region, size_t offset,
+        size_t size)
+{
+    return (offset <= region->_total_cap) &&
+        (size <= region->_total_cap - offset);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -101,72 +508,168 @@ static void _region_list_init(RegionList* list)
     list->_tail = NULL;
 }
 
-static void _region_list_push_back(RegionList* list, size_t total_cap,
-        gc_status* out_status)
+static void _region_list_append(RegionList* list, Region* region)
 {
-    Region* new = _region_alloc(total_cap);
-    if(new == NULL)
-    {
-        GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
-    }
-
     if(list->_head == NULL)
     {
-        list->_head = new;
-        list->_tail = new;
+        list->_head = region;
+        list->_tail = region;
     }
     else
     {
-        list->_tail->_next = new;
-        list->_tail = new;
+        list->_tail->_next = region;
+        list->_tail = region;
     }
 
     list->_count++;
-
-    GC_VRETURN(out_status, GC_SUCCESS);
 }
 
-static void _region_list_pop_front(RegionList* list)
+/* Detaches 'region' from the list. 'prev' is the region before it, NULL if
+ * 'region' is the head. */
+static void _region_list_remove(RegionList* list, Region* prev,
+        Region* region)
 {
-    if(list->_head == list->_tail)
-    {
-        _region_destroy(list->_head);
-        list->_head = NULL;
-        list->_tail = NULL;
-    }
+    if(prev == NULL)
+        list->_head = region->_next;
     else
-    {
-        Region* old_head = list->_head;
+        prev->_next = region->_next;
 
-        list->_head = list->_head->_next;
-
-        _region_destroy(old_head);
-    }
+    if(list->_tail == region)
+        list->_tail = prev;
 
+    region->_next = NULL;
     list->_count--;
 }
 
+/* Detaches the head of the list and returns it. */
+static Region* _region_list_pop_front(RegionList* list)
+{
+    Region* head = list->_head;
+
+    _region_list_remove(list, NULL, head);
+
+    return head;
+}
+
+/* Detaches every region except the head. Returns the detached regions, still
+ * linked through '_next'. */
+static Region* _region_list_truncate(RegionList* list)
+{
+    if(list->_head == NULL) return NULL;
+
+    Region* rest = list->_head->_next;
+
+    list->_head->_next = NULL;
+    list->_tail = list->_head;
+    list->_count = 1;
+
+    return rest;
+}
+
 /* -------------------------------------------------------------------------- */
 
-static void _gc_arena_init(GCArena arena, size_t region_cap, gc_status* out_status);
-static void* _gc_arena_malloc(GCArena arena, size_t size, gc_status* out_status);
+static void _gc_arena_init(GCArena arena, size_t region_cap, Region* first,
+        gc_status* out_status);
+static GCArena _gc_arena_create_image(char* image, size_t image_size,
+        size_t used, bool readonly, gc_status* out_status);
+static Region* _gc_arena_region_get(GCArena arena, size_t total_cap);
+static void _gc_arena_region_put(GCArena arena, Region* region);
+static void _gc_arena_region_put_all(GCArena arena, Region* regions);
+static void _gc_arena_decay_cache(GCArena arena);
+static void _gc_arena_push_region(GCArena arena, RegionList* list,
+        size_t total_cap, gc_status* out_status);
+static void* _gc_arena_malloc(GCArena arena, size_t size, size_t align,
+        gc_status* out_status);
+static Region* _gc_arena_next_region(GCArena arena, size_t min_cap,
+        gc_status* out_status);
+static size_t _gc_arena_next_region_cap(GCArena arena, size_t min_cap);
+static void _gc_arena_adapt(GCArena arena);
+static void _gc_arena_bin(GCArena arena, Region* region);
+static void _gc_arena_unbin(GCArena arena, Region* region);
+static void _gc_arena_clear_bins(GCArena arena);
+static void* _gc_arena_bin_malloc(GCArena arena, size_t size, size_t align);
+static void _gc_arena_sample_peak(GCArena arena);
+static void* _gc_arena_malloc_sync(GCArena arena, size_t size, size_t align,
+        gc_status* out_status);
+static void* _gc_arena_malloc_shared(GCArena arena, size_t size, size_t align,
+        gc_status* out_status);
+static void* _thread_cache_malloc(GCArena arena, size_t size, size_t align,
+        gc_status* out_status);
+static void* _thread_cache_refill(GCArena arena, struct ThreadCache* cache,
+        uint64_t epoch, size_t size, size_t align, gc_status* out_status);
+static void* _atomic_malloc(GCArena arena, size_t size, size_t align,
+        gc_status* out_status);
+static void* _gc_arena_large_malloc(GCArena arena, size_t size, size_t align,
+        gc_status* out_status);
+static bool _gc_arena_resize(GCArena arena, char* ptr, size_t old_size,
+        size_t new_size);
+static bool _thread_cache_resize(GCArena arena, char* ptr, size_t old_size,
+        size_t new_size);
+static bool _region_resize(Region* region, char* ptr, size_t old_size,
+        size_t new_size, bool atomic);
 
 /* -------------------------------------------------------------------------- */
 
 GCArena gc_arena_create(size_t region_cap, gc_status* out_status)
 {
+    struct GCArenaOptions options = {0};
+
+    return gc_arena_create_(region_cap, options, out_status);
+}
+
+GCArena gc_arena_create_(size_t region_cap, struct GCArenaOptions options,
+        gc_status* out_status)
+{
+    // a single-threaded arena has nothing to synchronize
+    if((options.flags & GC_ARENA_SINGLE_THREAD) &&
+            (options.flags & (GC_ARENA_THREAD_CACHE | GC_ARENA_ATOMIC)))
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
     GCArena new = (GCArena)malloc(sizeof(struct GCArena));
     if(new == NULL)
     {
         GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
     }
 
+    switch(options.growth_policy)
+    {
+        case GC_ARENA_GROWTH_FIXED:
+            options.max_region_cap = region_cap;
+            break;
+        case GC_ARENA_GROWTH_GEOMETRIC:
+        case GC_ARENA_GROWTH_ADAPTIVE:
+            if(options.growth_factor <= 1.0)
+                options.growth_factor = DEFAULT_GROWTH_FACTOR;
+            if(options.max_region_cap < region_cap)
+            {
+                options.max_region_cap =
+                    (region_cap <= SIZE_MAX / DEFAULT_MAX_REGION_FACTOR) ?
+                    region_cap * DEFAULT_MAX_REGION_FACTOR : SIZE_MAX;
+            }
+            break;
+        default:
+            free(new);
+            GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    if((options.thread_cache_cap == 0) ||
+            (options.thread_cache_cap > region_cap))
+    {
+        options.thread_cache_cap = region_cap / THREAD_CACHE_DEFAULT_DIV;
+        if(options.thread_cache_cap == 0)
+            options.thread_cache_cap = 1;
+    }
+    new->_options = options;
+
     gc_status _status;
-    _gc_arena_init(new, region_cap, &_status);
+    _gc_arena_init(new, region_cap, NULL, &_status);
 
     switch(_status)
     {
         case GC_SUCCESS:
+            pthread_mutex_init(&new->_lock, NULL);
             GC_RETURN(new, out_status, GC_SUCCESS);
         case GC_ERR_INVALID_ARG:
             free(new);
@@ -188,8 +691,22 @@ void gc_arena_destroy(GCArena arena, gc_status* out_status)
     }
 
     while(arena->_regions._count > 0)
-        _region_list_pop_front(&arena->_regions);
+        _region_destroy(_region_list_pop_front(&arena->_regions));
+
+    while(arena->_large._count > 0)
+        _region_destroy(_region_list_pop_front(&arena->_large));
+
+    while(arena->_cache._count > 0)
+        _region_destroy(_region_list_pop_front(&arena->_cache));
+
+    if(arena->_image != NULL)
+        munmap(arena->_image, arena->_image_size);
+
+    // other threads' slots are left to be reused or taken
+    if(arena->_options.flags & GC_ARENA_THREAD_CACHE)
+        _thread_cache_forget(arena);
 
+    arena->_image = NULL;
     arena->_region_cap = 0;
     arena->_rewind_it = NULL;
     pthread_mutex_destroy(&arena->_lock);
@@ -205,12 +722,10 @@ void* gc_arena_malloc(GCArena arena, size_t size, gc_status* out_status)
         GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
     }
 
-    ARENA_LOCK(arena);
-
     gc_status _status;
-    void* alloc_addr = _gc_arena_malloc(arena, size, &_status);
+    void* alloc_addr = _gc_arena_malloc_sync(arena, size, ARENA_DEFAULT_ALIGN,
+            &_status);
 
-    ARENA_UNLOCK(arena);
     switch(_status)
     {
         case GC_SUCCESS:
@@ -224,24 +739,20 @@ void* gc_arena_malloc(GCArena arena, size_t size, gc_status* out_status)
     }
 }
 
-void* gc_arena_calloc(GCArena arena, size_t size, gc_status* out_status)
+void* gc_arena_malloc_aligned(GCArena arena, size_t size, size_t align,
+        gc_status* out_status)
 {
-    if(arena == NULL)
+    if((arena == NULL) || (align == 0) || ((align & (align - 1)) != 0))
     {
         GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
     }
 
-    ARENA_LOCK(arena);
-
     gc_status _status;
-    void* alloc_addr = _gc_arena_malloc(arena, size, &_status);
-
-    ARENA_UNLOCK(arena);
+    void* alloc_addr = _gc_arena_malloc_sync(arena, size, align, &_status);
 
     switch(_status)
     {
         case GC_SUCCESS:
-            memset(alloc_addr, 0, size);
             GC_RETURN(alloc_addr, out_status, GC_SUCCESS);
         case GC_ERR_INVALID_ARG:
             GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
@@ -252,117 +763,1329 @@ void* gc_arena_calloc(GCArena arena, size_t size, gc_status* out_status)
     }
 }
 
-void gc_arena_rewind(GCArena arena, gc_status* out_status)
+void* gc_arena_calloc(GCArena arena, size_t size, gc_status* out_status)
 {
     if(arena == NULL)
     {
-        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
     }
 
-    ARENA_LOCK(arena);
+    gc_status _status;
+    void* alloc_addr = _gc_arena_malloc_sync(arena, size, ARENA_DEFAULT_ALIGN,
+            &_status);
 
-    if(arena->_regions._count == 0) 
+    switch(_status)
     {
-        ARENA_UNLOCK(arena);
-        GC_VRETURN(out_status, GC_SUCCESS);
+        case GC_SUCCESS:
+            memset(alloc_addr, 0, size);
+            GC_RETURN(alloc_addr, out_status, GC_SUCCESS);
+        case GC_ERR_INVALID_ARG:
+            GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+        case GC_ERR_ALLOC_FAIL:
+            GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+        default:
+            GC_RETURN(NULL, out_status, GC_ERR_UNHANDLED);
     }
-
-    Region* it = arena->_regions._head;
-
-    for(; it != NULL; it = it->_next)
-        it->_used_cap = 0;
-
-    // start rewinding if more regions exist
-    if(arena->_regions._count > 1)
-        arena->_rewind_it = arena->_regions._head;
-
-    ARENA_UNLOCK(arena);
-
-    GC_VRETURN(out_status, GC_SUCCESS);
 }
 
-void gc_arena_reset(GCArena arena, gc_status* out_status)
+/* Reserves a single block for 'n' blocks of 'stride' bytes(or of the sizes
+ * in 'sizes', each rounded up to ARENA_DEFAULT_ALIGN, if 'sizes' is not NULL)
+ * and stores their addresses in 'out_ptrs'. */
+static void _gc_arena_malloc_batch(GCArena arena, const size_t* sizes,
+        size_t stride, size_t n, void** out_ptrs, gc_status* out_status)
 {
-    ARENA_LOCK(arena);
-
-    while(arena->_regions._count > 0)
-        _region_list_pop_front(&arena->_regions);
-
-    gc_status err;
-    _gc_arena_init(arena, arena->_region_cap, &err);
-
-    ARENA_UNLOCK(arena);
+    size_t total = 0;
+    size_t i;
 
-    GC_VRETURN(out_status, GC_SUCCESS);
-}
+    if(sizes != NULL)
+    {
+        for(i = 0; i < n; i++)
+        {
+            if((sizes[i] == 0) || (sizes[i] > SIZE_MAX - ARENA_DEFAULT_ALIGN))
+            {
+                GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+            }
 
-/* -------------------------------------------------------------------------- */
+            size_t block = ARENA_ALIGN_UP(sizes[i], ARENA_DEFAULT_ALIGN);
+            if(block > SIZE_MAX - total)
+            {
+                GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+            }
 
-static void _gc_arena_init(GCArena arena, size_t region_cap, gc_status* out_status)
-{
-    if(region_cap == 0)
-    {
-        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+            total += block;
+        }
     }
+    else
+    {
+        if(stride > SIZE_MAX / n)
+        {
+            GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+        }
 
-    arena->_region_cap = region_cap;
-    arena->_rewind_it = NULL;
-    _region_list_init(&arena->_regions);
+        total = stride * n;
+    }
 
     gc_status _status;
-    _region_list_push_back(&arena->_regions, region_cap, &_status);
+    char* block = _gc_arena_malloc_sync(arena, total, ARENA_DEFAULT_ALIGN,
+            &_status);
 
     switch(_status)
     {
         case GC_SUCCESS:
-            pthread_mutex_init(&arena->_lock, NULL);
-            GC_VRETURN(out_status, GC_SUCCESS);
+            break;
         case GC_ERR_ALLOC_FAIL:
             GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
         default:
             GC_VRETURN(out_status, GC_ERR_UNHANDLED);
     }
+
+    for(i = 0; i < n; i++)
+    {
+        out_ptrs[i] = block;
+
+        block += (sizes != NULL) ?
+            ARENA_ALIGN_UP(sizes[i], ARENA_DEFAULT_ALIGN) : stride;
+    }
+
+    GC_VRETURN(out_status, GC_SUCCESS);
 }
 
-static void* _gc_arena_malloc(GCArena arena, size_t size, gc_status* out_status)
+void gc_arena_malloc_batch(GCArena arena, const size_t* sizes, size_t n,
+        void** out_ptrs, gc_status* out_status)
 {
-    if((size > arena->_region_cap) || (size == 0))
+    if((arena == NULL) || (sizes == NULL) || (n == 0) || (out_ptrs == NULL))
     {
-        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
     }
 
+    _gc_arena_malloc_batch(arena, sizes, 0, n, out_ptrs, out_status);
+}
+
+void gc_arena_malloc_batch_uniform(GCArena arena, size_t size, size_t n,
+        void** out_ptrs, gc_status* out_status)
+{
+    if((arena == NULL) || (size == 0) || (n == 0) || (out_ptrs == NULL) ||
+            (size > SIZE_MAX - ARENA_DEFAULT_ALIGN))
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    _gc_arena_malloc_batch(arena, NULL,
+            ARENA_ALIGN_UP(size, ARENA_DEFAULT_ALIGN), n, out_ptrs, out_status);
+}
+
+void* gc_arena_realloc(GCArena arena, void* ptr, size_t old_size,
+        size_t new_size, gc_status* out_status)
+{
+    if((arena == NULL) || (new_size == 0))
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    if(ptr == NULL)
+        return gc_arena_malloc(arena, new_size, out_status);
+
+    if(_gc_arena_resize(arena, ptr, old_size, new_size) ||
+            (new_size <= old_size))
+    {
+        GC_RETURN(ptr, out_status, GC_SUCCESS);
+    }
+
+    gc_status _status;
+    void* new_ptr = _gc_arena_malloc_sync(arena, new_size, ARENA_DEFAULT_ALIGN,
+            &_status);
+
+    switch(_status)
+    {
+        case GC_SUCCESS:
+            memcpy(new_ptr, ptr, old_size);
+            GC_RETURN(new_ptr, out_status, GC_SUCCESS);
+        case GC_ERR_ALLOC_FAIL:
+            GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+        default:
+            GC_RETURN(NULL, out_status, GC_ERR_UNHANDLED);
+    }
+}
+
+void gc_arena_rewind(GCArena arena, gc_status* out_status)
+{
+    if((arena == NULL) || arena->_image_readonly)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    ARENA_LOCK(arena);
+
+    if(arena->_regions._count == 0) 
+    {
+        ARENA_UNLOCK(arena);
+        GC_VRETURN(out_status, GC_SUCCESS);
+    }
+
+    _gc_arena_clear_bins(arena);
+
+    _gc_arena_sample_peak(arena);
+    arena->_stats.rewind_count++;
+
+    if(arena->_options.growth_policy == GC_ARENA_GROWTH_ADAPTIVE)
+        _gc_arena_adapt(arena);
+
+    bool trim = (arena->_options.flags & GC_ARENA_TRIM_ON_REWIND);
+
+    Region* it = arena->_regions._head;
+
+    for(; it != NULL; it = it->_next)
+    {
+        // regions not touched during the last cycle are cold
+        if(trim && (REGION_USED(it) == 0)) _region_trim(it);
+
+        REGION_SET_USED(it, 0);
+    }
+
+    // large regions become available to large allocations that fit
+    for(it = arena->_large._head; it != NULL; it = it->_next)
+    {
+        if(trim && (REGION_USED(it) == 0)) _region_trim(it);
+
+        REGION_SET_USED(it, 0);
+    }
+
+    // start rewinding if more regions exist
+    if(arena->_regions._count > 1)
+        arena->_rewind_it = arena->_regions._head;
+
+    atomic_store_explicit(&arena->_active, arena->_regions._head,
+            memory_order_release);
+
+    arena->_cycle++;
+    _gc_arena_decay_cache(arena);
+    _arena_next_epoch(arena);
+
+    ARENA_UNLOCK(arena);
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+void gc_arena_reset(GCArena arena, gc_status* out_status)
+{
+    if((arena == NULL) || arena->_image_readonly)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    ARENA_LOCK(arena);
+
+    _gc_arena_clear_bins(arena);
+
+    arena->_stats.peak_usage = 0;
+
+    if(arena->_options.growth_policy == GC_ARENA_GROWTH_ADAPTIVE)
+        _gc_arena_adapt(arena);
+
+    _gc_arena_region_put_all(arena, _region_list_truncate(&arena->_regions));
+    REGION_SET_USED(arena->_regions._head, 0);
+
+    while(arena->_large._count > 0)
+        _gc_arena_region_put(arena, _region_list_pop_front(&arena->_large));
+
+    arena->_rewind_it = NULL;
+    atomic_store_explicit(&arena->_active, arena->_regions._head,
+            memory_order_release);
+
+    arena->_cycle++;
+    _gc_arena_decay_cache(arena);
+    _arena_next_epoch(arena);
+
+    ARENA_UNLOCK(arena);
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+GCArenaMark gc_arena_mark(GCArena arena, gc_status* out_status)
+{
+    GCArenaMark mark = {0};
+
+    if(arena == NULL)
+    {
+        GC_RETURN(mark, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    ARENA_LOCK(arena);
+
+    /* Everything allocated after the mark must come after it in region order,
+     * so regions left behind before the mark are not used anymore. */
+    _gc_arena_clear_bins(arena);
+
+    Region* active = atomic_load_explicit(&arena->_active,
+            memory_order_relaxed);
+
+    mark._region = active;
+    mark._used_cap = atomic_load_explicit(&active->_used_cap,
+            memory_order_relaxed);
+    mark._large_seq = arena->_large_seq;
+    mark._cycle = arena->_cycle;
+
+    ARENA_UNLOCK(arena);
+
+    GC_RETURN(mark, out_status, GC_SUCCESS);
+}
+
+void gc_arena_rewind_to(GCArena arena, GCArenaMark mark, gc_status* out_status)
+{
+    if((arena == NULL) || (mark._region == NULL))
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    ARENA_LOCK(arena);
+
+    if(mark._cycle != arena->_cycle)
+    {
+        ARENA_UNLOCK(arena);
+        GC_VRETURN(out_status, GC_ERR_ARENA_STALE_MARK);
+    }
+
+    Region* region = (Region*)mark._region;
+    Region* active = atomic_load_explicit(&arena->_active,
+            memory_order_relaxed);
+
+    // regions left behind after the mark are emptied below
+    _gc_arena_clear_bins(arena);
+
+    // empty the regions used after the mark, up to the active one
+    if(region != active)
+    {
+        Region* it = region->_next;
+        for(; it != NULL; it = it->_next)
+        {
+            REGION_SET_USED(it, 0);
+            if(it == active) break;
+        }
+    }
+
+    REGION_SET_USED(region, mark._used_cap);
+
+    // the regions after the marked one are reused, as after a rewind
+    arena->_rewind_it = (region == arena->_regions._tail) ? NULL : region;
+    atomic_store_explicit(&arena->_active, region, memory_order_release);
+
+    Region* it = arena->_large._head;
+    for(; it != NULL; it = it->_next)
+    {
+        if(it->_seq > mark._large_seq)
+            REGION_SET_USED(it, 0);
+    }
+
+    // chunks taken by threads after the mark may no longer be used
+    if(arena->_options.flags & GC_ARENA_THREAD_CACHE)
+        _arena_next_epoch(arena);
+
+    ARENA_UNLOCK(arena);
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+struct GCArenaStats gc_arena_stats(GCArena arena, gc_status* out_status)
+{
+    struct GCArenaStats stats = {0};
+
+    if(arena == NULL)
+    {
+        GC_RETURN(stats, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    ARENA_LOCK(arena);
+
+    _gc_arena_sample_peak(arena);
+
+    stats = arena->_stats;
+
+    Region* active = atomic_load_explicit(&arena->_active,
+            memory_order_relaxed);
+    bool passed_active = false;
+
+    Region* it = arena->_regions._head;
+    for(; it != NULL; it = it->_next)
+    {
+        size_t used = atomic_load_explicit(&it->_used_cap,
+                memory_order_relaxed);
+
+        stats.region_count++;
+        stats.bytes_reserved += it->_total_cap;
+        stats.bytes_used += used;
+
+        if(it == active) passed_active = true;
+        else if(!passed_active) stats.tail_waste += it->_total_cap - used;
+    }
+
+    for(it = arena->_large._head; it != NULL; it = it->_next)
+    {
+        stats.large_region_count++;
+        stats.bytes_reserved += it->_total_cap;
+        stats.bytes_used += REGION_USED(it);
+    }
+
+    for(it = arena->_cache._head; it != NULL; it = it->_next)
+    {
+        stats.cached_region_count++;
+        stats.bytes_cached += it->_total_cap;
+    }
+
+    ARENA_UNLOCK(arena);
+
+    GC_RETURN(stats, out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Initializes the arena's fields. If 'first' is not NULL, it becomes the
+ * arena's first region, otherwise a region of 'region_cap' bytes is
+ * allocated. */
+static void _gc_arena_init(GCArena arena, size_t region_cap, Region* first,
+        gc_status* out_status)
+{
+    if(region_cap == 0)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    arena->_region_cap = region_cap;
+    arena->_max_region_cap = arena->_options.max_region_cap;
+    arena->_rewind_it = NULL;
+    arena->_large_seq = 0;
+    arena->_cycle = 0;
+    memset(arena->_bins, 0, sizeof(arena->_bins));
+    arena->_bin_mask = 0;
+    memset(&arena->_stats, 0, sizeof(arena->_stats));
+    _arena_next_epoch(arena);
+    _region_list_init(&arena->_regions);
+    _region_list_init(&arena->_large);
+    _region_list_init(&arena->_cache);
+    arena->_image = NULL;
+    arena->_image_size = 0;
+    arena->_image_readonly = false;
+
+    gc_status _status = GC_SUCCESS;
+    if(first != NULL)
+        _region_list_append(&arena->_regions, first);
+    else
+        _gc_arena_push_region(arena, &arena->_regions, region_cap, &_status);
+
+    switch(_status)
+    {
+        case GC_SUCCESS:
+            atomic_init(&arena->_active, arena->_regions._tail);
+            GC_VRETURN(out_status, GC_SUCCESS);
+        case GC_ERR_ALLOC_FAIL:
+            GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+        default:
+            GC_VRETURN(out_status, GC_ERR_UNHANDLED);
+    }
+}
+
+static void* _gc_arena_malloc(GCArena arena, size_t size, size_t align,
+        gc_status* out_status)
+{
+    if(size == 0)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+    if(_arena_is_large(arena, size, align))
+        return _gc_arena_large_malloc(arena, size, align, out_status);
+
+    Region* curr_region = (arena->_rewind_it == NULL) ?
+        arena->_regions._tail : arena->_rewind_it;
+
+    size_t offset = _region_align_offset(curr_region, REGION_USED(curr_region),
+            align);
+
+    // not enough memory in region - try the regions left behind
+    if(!_region_fits(curr_region, offset, size))
+    {
+        void* alloc_addr = _gc_arena_bin_malloc(arena, size, align);
+        if(alloc_addr != NULL)
+        {
+            GC_RETURN(alloc_addr, out_status, GC_SUCCESS);
+        }
+    }
+
+    // rewound regions may be too small as well
+    while(!_region_fits(curr_region, offset, size))
+    {
+        gc_status _status;
+        curr_region = _gc_arena_next_region(arena,
+                size + ARENA_POOL_PADDING(align), &_status);
+
+        if(_status != GC_SUCCESS)
+        {
+            GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+        }
+
+        offset = _region_align_offset(curr_region, REGION_USED(curr_region),
+                align);
+    }
+
+    void* alloc_addr = curr_region->_mem_pool + offset;
+    REGION_SET_USED(curr_region, offset + size);
+
+    GC_RETURN(alloc_addr, out_status, GC_SUCCESS);
+}
+
+/* Moves on to the region after the active one. Pushes back a new region(of
+ * at least 'min_cap' bytes) if not rewinding, otherwise advances the rewind
+ * iterator. Must be called with the lock held. Returns the new active
+ * region. */
+static Region* _gc_arena_next_region(GCArena arena, size_t min_cap,
+        gc_status* out_status)
+{
     Region* curr_region = (arena->_rewind_it == NULL) ?
         arena->_regions._tail : arena->_rewind_it;
 
-    size_t curr_region_cap = curr_region->_total_cap - curr_region->_used_cap;
+    if(arena->_rewind_it == NULL) // if not rewinding, push back a region
+    {
+        gc_status _status;
+        _gc_arena_push_region(arena, &arena->_regions,
+                _gc_arena_next_region_cap(arena, min_cap), &_status);
+
+        if(_status != GC_SUCCESS)
+        {
+            GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+        }
+    }
+    else // if rewinding, advance rewind iterator
+    {
+        arena->_rewind_it = arena->_rewind_it->_next;
+
+        // if at the tail, turn of rewinding
+        if(arena->_rewind_it == arena->_regions._tail)
+            arena->_rewind_it = NULL;
+    }
+
+    // the region being left behind may still serve smaller allocations
+    if(!(arena->_options.flags & GC_ARENA_ATOMIC))
+        _gc_arena_bin(arena, curr_region);
+
+    // advance the curr_region ptr after allocing region/advancing rewind
+    curr_region = curr_region->_next;
+
+    atomic_store_explicit(&arena->_active, curr_region, memory_order_release);
+
+    GC_RETURN(curr_region, out_status, GC_SUCCESS);
+}
+
+/* Capacity of the next region pushed back to the region list, according to
+ * the arena's growth policy. Never less than 'min_cap'. */
+static size_t _gc_arena_next_region_cap(GCArena arena, size_t min_cap)
+{
+    size_t cap = arena->_region_cap;
+
+    if(arena->_options.growth_policy != GC_ARENA_GROWTH_FIXED)
+    {
+        double grown = arena->_regions._tail->_total_cap *
+            arena->_options.growth_factor;
+
+        cap = (grown >= (double)arena->_max_region_cap) ?
+            arena->_max_region_cap : (size_t)grown;
+    }
+
+    return (cap > min_cap) ? cap : min_cap;
+}
+
+/* GC_ARENA_GROWTH_ADAPTIVE - called at the end of a cycle(rewind/reset),
+ * before the regions are emptied. If the cycle needed more than one region,
+ * the regions are replaced by a single region sized to the cycle's high-water
+ * mark(plus some headroom), unless that would exceed '_max_region_cap'. A
+ * single region is also replaced if that is less than a quarter of its size.
+ * If the new region cannot be allocated, the regions are kept as they are.
+ * Must be called with the lock held. */
+static void _gc_arena_adapt(GCArena arena)
+{
+    size_t used = 0;
+    Region* it = arena->_regions._head;
+    for(; it != NULL; it = it->_next)
+        used += REGION_USED(it);
+
+    /* Headroom, so that a slightly bigger cycle (or a different alignment
+     * padding) does not spill into a second region again. */
+    size_t target = used + used / ADAPTIVE_HEADROOM_DIV;
+    if(target < arena->_region_cap) target = arena->_region_cap;
+
+    // a single region could not hold the whole cycle - keep the regions
+    if(target > arena->_max_region_cap) return;
+
+    Region* head = arena->_regions._head;
+
+    if(arena->_regions._count == 1)
+    {
+        // the cycle fit - only shrink a region that is far too big
+        if(target >= head->_total_cap / 4) return;
+    }
+    else if(target <= head->_total_cap)
+    {
+        // the head would have been enough - drop the rest
+        _gc_arena_region_put_all(arena,
+                _region_list_truncate(&arena->_regions));
+        return;
+    }
+
+    Region* new = _gc_arena_region_get(arena, target);
+    if(new == NULL) return;
+
+    while(arena->_regions._count > 0)
+        _gc_arena_region_put(arena, _region_list_pop_front(&arena->_regions));
+
+    _region_list_append(&arena->_regions, new);
+    arena->_rewind_it = NULL;
+}
+
+/* Returns an empty region of at least 'total_cap' bytes - the smallest cached
+ * region that fits(and is not too big), otherwise a newly allocated one. Must
+ * be called with the lock held. */
+static Region* _gc_arena_region_get(GCArena arena, size_t total_cap)
+{
+    size_t max_cap = (total_cap <= SIZE_MAX / ARENA_CACHE_FIT) ?
+        total_cap * ARENA_CACHE_FIT : SIZE_MAX;
+
+    Region* best = NULL;
+    Region* best_prev = NULL;
+
+    Region* prev = NULL;
+    Region* it = arena->_cache._head;
+    for(; it != NULL; prev = it, it = it->_next)
+    {
+        if((it->_total_cap < total_cap) || (it->_total_cap > max_cap))
+            continue;
+
+        if((best == NULL) || (it->_total_cap < best->_total_cap))
+        {
+            best = it;
+            best_prev = prev;
+        }
+    }
+
+    if(best != NULL)
+    {
+        _region_list_remove(&arena->_cache, best_prev, best);
+        REGION_SET_USED(best, 0);
+        best->_seq = 0;
+
+        return best;
+    }
+
+    Region* new = _region_alloc(total_cap, arena->_options.flags);
+    if(new != NULL) arena->_stats.region_allocs++;
+
+    return new;
+}
+
+/* Puts a region detached from the region lists into the cache, evicting the
+ * oldest cached region if the cache is full. The region must not be binned.
+ * Must be called with the lock held. */
+static void _gc_arena_region_put(GCArena arena, Region* region)
+{
+    if(arena->_cache._count == ARENA_CACHE_MAX)
+        _region_destroy(_region_list_pop_front(&arena->_cache));
+
+    // a cached region is cold by definition
+    if(arena->_options.flags & GC_ARENA_TRIM_ON_REWIND)
+        _region_trim(region);
+
+    region->_cached_cycle = arena->_cycle;
+    _region_list_append(&arena->_cache, region);
+}
+
+/* Puts every region of a detached chain(linked through '_next') into the
+ * cache. */
+static void _gc_arena_region_put_all(GCArena arena, Region* regions)
+{
+    Region* next;
+    for(; regions != NULL; regions = next)
+    {
+        next = regions->_next;
+        regions->_next = NULL;
+
+        _gc_arena_region_put(arena, regions);
+    }
+}
+
+/* Frees the cached regions that were not reused for ARENA_CACHE_DECAY cycles.
+ * Called at the end of every cycle, with the lock held. */
+static void _gc_arena_decay_cache(GCArena arena)
+{
+    while((arena->_cache._head != NULL) && (arena->_cycle -
+                arena->_cache._head->_cached_cycle >= ARENA_CACHE_DECAY))
+        _region_destroy(_region_list_pop_front(&arena->_cache));
+}
+
+/* Appends a region of at least 'total_cap' bytes to 'list'(see
+ * _gc_arena_region_get()). */
+static void _gc_arena_push_region(GCArena arena, RegionList* list,
+        size_t total_cap, gc_status* out_status)
+{
+    // file-backed arenas cannot grow
+    if(arena->_image != NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    Region* new = _gc_arena_region_get(arena, total_cap);
+    if(new == NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    _region_list_append(list, new);
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+/* Allocates from the arena, taking the arena's lock or using the calling
+ * thread's chunk, depending on the arena's options. */
+static void* _gc_arena_malloc_sync(GCArena arena, size_t size, size_t align,
+        gc_status* out_status)
+{
+    if(arena->_options.flags & GC_ARENA_THREAD_CACHE)
+        return _thread_cache_malloc(arena, size, align, out_status);
+
+    return _gc_arena_malloc_shared(arena, size, align, out_status);
+}
+
+/* Allocates from the active region, shared by all threads. */
+static void* _gc_arena_malloc_shared(GCArena arena, size_t size, size_t align,
+        gc_status* out_status)
+{
+    if(arena->_options.flags & GC_ARENA_ATOMIC)
+        return _atomic_malloc(arena, size, align, out_status);
+
+    ARENA_LOCK(arena);
+
+    void* alloc_addr = _gc_arena_malloc(arena, size, align, out_status);
+
+    ARENA_UNLOCK(arena);
+
+    return alloc_addr;
+}
+
+static void* _thread_cache_malloc(GCArena arena, size_t size, size_t align,
+        gc_status* out_status)
+{
+    uint64_t epoch = atomic_load_explicit(&arena->_epoch, memory_order_acquire);
+
+    struct ThreadCache* cache = _thread_cache_find(arena, epoch);
+
+    // fast path - serve from the thread's chunk, lock-free
+    if((cache != NULL) && (size > 0))
+    {
+        uintptr_t pos = (uintptr_t)cache->_pos;
+        char* alloc_addr =
+            (char*)((pos + (align - 1)) & ~(uintptr_t)(align - 1));
+
+        if((alloc_addr <= cache->_end) &&
+                (size <= (size_t)(cache->_end - alloc_addr)))
+        {
+            cache->_pos = alloc_addr + size;
+
+            GC_RETURN(alloc_addr, out_status, GC_SUCCESS);
+        }
+    }
+
+    return _thread_cache_refill(arena, cache, epoch, size, align, out_status);
+}
+
+/* Slow path of _thread_cache_malloc() - takes a new chunk for the calling
+ * thread and allocates from it. 'cache' is the thread's slot of 'arena', or
+ * NULL if it has none. */
+__attribute__((noinline))
+static void* _thread_cache_refill(GCArena arena, struct ThreadCache* cache,
+        uint64_t epoch, size_t size, size_t align, gc_status* out_status)
+{
+    size_t chunk_cap = arena->_options.thread_cache_cap;
+
+    // too big for a chunk - allocate directly from the active region
+    if((size == 0) || (align > chunk_cap) ||
+            (size > chunk_cap - ARENA_POOL_PADDING(align)))
+        return _gc_arena_malloc_shared(arena, size, align, out_status);
+
+    /* The epoch is read before the chunk is taken. If the arena is rewound in
+     * between, the chunk is tagged with the old epoch and simply dropped. */
+    gc_status _status;
+    char* chunk = _gc_arena_malloc_shared(arena, chunk_cap,
+            (align > ARENA_DEFAULT_ALIGN) ? align : ARENA_DEFAULT_ALIGN,
+            &_status);
 
-    if(size > curr_region_cap) // not enough memory in current region
+    if(_status != GC_SUCCESS)
     {
-        if(arena->_rewind_it == NULL) // if not rewinding, push back a region
-        {
-            gc_status _status;
-            _region_list_push_back(&arena->_regions, arena->_region_cap, &_status);
+        GC_RETURN(NULL, out_status, _status);
+    }
+
+    if(cache == NULL) cache = _thread_cache_slot(arena);
+
+    cache->_arena = arena;
+    cache->_epoch = epoch;
+    cache->_pos = chunk + size;
+    cache->_end = chunk + chunk_cap;
+
+    GC_RETURN(chunk, out_status, GC_SUCCESS);
+}
+
+/* Resizes 'ptr' without moving it, if it is the last allocation in the
+ * calling thread's chunk or in the active region. */
+static bool _gc_arena_resize(GCArena arena, char* ptr, size_t old_size,
+        size_t new_size)
+{
+    if(arena->_image_readonly) return false;
+
+    if((arena->_options.flags & GC_ARENA_THREAD_CACHE) &&
+            _thread_cache_resize(arena, ptr, old_size, new_size))
+        return true;
+
+    if(arena->_options.flags & GC_ARENA_ATOMIC)
+    {
+        Region* region = atomic_load_explicit(&arena->_active,
+                memory_order_acquire);
+
+        return _region_resize(region, ptr, old_size, new_size, true);
+    }
+
+    ARENA_LOCK(arena);
+
+    bool resized = _region_resize(atomic_load_explicit(&arena->_active,
+                memory_order_relaxed), ptr, old_size, new_size, false);
+
+    ARENA_UNLOCK(arena);
+
+    return resized;
+}
+
+/* GC_ARENA_THREAD_CACHE - moves the end of the calling thread's chunk, if
+ * 'ptr' is the chunk's last allocation. Lock-free. */
+static bool _thread_cache_resize(GCArena arena, char* ptr, size_t old_size,
+        size_t new_size)
+{
+    uint64_t epoch = atomic_load_explicit(&arena->_epoch, memory_order_acquire);
+
+    struct ThreadCache* cache = _thread_cache_find(arena, epoch);
+
+    if(cache == NULL) return false;
+
+    uintptr_t addr = (uintptr_t)ptr;
+    if((addr > (uintptr_t)cache->_pos) ||
+            (old_size != (uintptr_t)cache->_pos - addr) ||
+            (new_size > (uintptr_t)cache->_end - addr))
+        return false;
+
+    cache->_pos = ptr + new_size;
+
+    return true;
+}
+
+/* Moves the region's '_used_cap', if 'ptr' is the region's last allocation.
+ * With 'atomic', a CAS is used, so GC_ARENA_ATOMIC arenas may call this
+ * without the lock; otherwise the lock must be held. */
+static bool _region_resize(Region* region, char* ptr, size_t old_size,
+        size_t new_size, bool atomic)
+{
+    uintptr_t addr = (uintptr_t)ptr;
+    uintptr_t pool = (uintptr_t)region->_mem_pool;
+
+    if((addr < pool) || (addr - pool > region->_total_cap))
+        return false;
+
+    size_t offset = addr - pool;
+    if((old_size > region->_total_cap - offset) ||
+            (new_size > region->_total_cap - offset))
+        return false;
+
+    size_t used = offset + old_size;
+
+    if(atomic)
+        return atomic_compare_exchange_strong_explicit(&region->_used_cap,
+                &used, offset + new_size,
+                memory_order_relaxed, memory_order_relaxed);
+
+    if(REGION_USED(region) != used) return false;
+
+    REGION_SET_USED(region, offset + new_size);
+
+    return true;
+}
+
+/* GC_ARENA_ATOMIC - reserves space in the active region with a CAS on its
+ * '_used_cap'. Only moving on to the next region takes the lock. */
+static void* _atomic_malloc(GCArena arena, size_t size, size_t align,
+        gc_status* out_status)
+{
+    if(size == 0)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+    if(_arena_is_large(arena, size, align))
+    {
+        ARENA_LOCK(arena);
+
+        void* alloc_addr = _gc_arena_large_malloc(arena, size, align,
+                out_status);
+
+        ARENA_UNLOCK(arena);
+
+        return alloc_addr;
+    }
+
+    while(true)
+    {
+        Region* region = atomic_load_explicit(&arena->_active,
+                memory_order_acquire);
+
+        size_t used = atomic_load_explicit(&region->_used_cap,
+                memory_order_relaxed);
+        size_t offset = _region_align_offset(region, used, align);
 
-            if(_status != GC_SUCCESS)
+        while(_region_fits(region, offset, size))
+        {
+            if(atomic_compare_exchange_weak_explicit(&region->_used_cap,
+                        &used, offset + size,
+                        memory_order_relaxed, memory_order_relaxed))
             {
-                GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+                GC_RETURN(region->_mem_pool + offset, out_status, GC_SUCCESS);
             }
+
+            offset = _region_align_offset(region, used, align);
+        }
+
+        ARENA_LOCK(arena);
+
+        // another thread may have already moved on to the next region
+        gc_status _status = GC_SUCCESS;
+        Region* active = atomic_load_explicit(&arena->_active,
+                memory_order_relaxed);
+        if(active == region)
+            _gc_arena_next_region(arena, size + ARENA_POOL_PADDING(align),
+                    &_status);
+
+        ARENA_UNLOCK(arena);
+
+        if(_status != GC_SUCCESS)
+        {
+            GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+        }
+    }
+}
+
+/* Serves an allocation larger than what a region can hold. Reuses the
+ * smallest unused large region that fits (large regions are unused after a
+ * rewind), otherwise pushes back a new large region, just big enough for
+ * 'size' bytes aligned to 'align'. Must be called with the lock held. */
+static void* _gc_arena_large_malloc(GCArena arena, size_t size, size_t align,
+        gc_status* out_status)
+{
+    // the region would need more than SIZE_MAX bytes
+    if(size > SIZE_MAX - ARENA_POOL_PADDING(align))
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    Region* best = NULL;
+    Region* it = arena->_large._head;
+    for(; it != NULL; it = it->_next)
+    {
+        if((REGION_USED(it) != 0) ||
+                !_region_fits(it, _region_align_offset(it, 0, align), size))
+            continue;
+
+        if((best == NULL) || (it->_total_cap < best->_total_cap))
+            best = it;
+    }
+
+    if(best == NULL)
+    {
+        gc_status _status;
+        _gc_arena_push_region(arena, &arena->_large,
+                size + ARENA_POOL_PADDING(align), &_status);
+
+        if(_status != GC_SUCCESS)
+        {
+            GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+        }
+
+        best = arena->_large._tail;
+
+        if(!_region_fits(best, _region_align_offset(best, 0, align), size))
+        {
+            GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
         }
-        else // if rewinding, advance rewind iterator
+    }
+
+    REGION_SET_USED(best, best->_total_cap);
+    best->_seq = ++arena->_large_seq;
+
+    GC_RETURN(best->_mem_pool + _region_align_offset(best, 0, align),
+            out_status, GC_SUCCESS);
+}
+
+/* Puts 'region' into the bin matching its free space. Must be called with
+ * the lock held. */
+static void _gc_arena_bin(GCArena arena, Region* region)
+{
+    size_t free_cap = region->_total_cap - REGION_USED(region);
+    if(free_cap < ARENA_BIN_MIN_FREE) return;
+
+    int bin = (int)(ARENA_BIN_COUNT - 1) -
+        __builtin_clzll((unsigned long long)free_cap);
+
+    region->_bin = bin;
+    region->_bin_prev = NULL;
+    region->_bin_next = arena->_bins[bin];
+
+    if(arena->_bins[bin] != NULL)
+        arena->_bins[bin]->_bin_prev = region;
+
+    arena->_bins[bin] = region;
+    arena->_bin_mask |= (uint64_t)1 << bin;
+}
+
+/* Removes 'region' from its bin. Must be called with the lock held. */
+static void _gc_arena_unbin(GCArena arena, Region* region)
+{
+    if(region->_bin_prev != NULL)
+        region->_bin_prev->_bin_next = region->_bin_next;
+    else
+        arena->_bins[region->_bin] = region->_bin_next;
+
+    if(arena->_bins[region->_bin] == NULL)
+        arena->_bin_mask &= ~((uint64_t)1 << region->_bin);
+
+    if(region->_bin_next != NULL)
+        region->_bin_next->_bin_prev = region->_bin_prev;
+
+    region->_bin = -1;
+    region->_bin_prev = NULL;
+    region->_bin_next = NULL;
+}
+
+/* Empties all bins. Must be called with the lock held. */
+static void _gc_arena_clear_bins(GCArena arena)
+{
+    while(arena->_bin_mask != 0)
+    {
+        int i = __builtin_ctzll(arena->_bin_mask);
+        arena->_bin_mask &= arena->_bin_mask - 1;
+
+        Region* it = arena->_bins[i];
+        Region* next;
+        for(; it != NULL; it = next)
         {
-            arena->_rewind_it = arena->_rewind_it->_next;
+            next = it->_bin_next;
 
-            // if at the tail, turn of rewinding
-            if(arena->_rewind_it == arena->_regions._tail)
-                arena->_rewind_it = NULL;
+            it->_bin = -1;
+            it->_bin_prev = NULL;
+            it->_bin_next = NULL;
         }
 
-        // advance the curr_region ptr after allocing region/advancing rewind
-        curr_region = curr_region->_next;
+        arena->_bins[i] = NULL;
     }
+}
+
+/* Serves the allocation from the first binned region that can hold it,
+ * starting from the smallest bin that may. The region is re-binned according
+ * to its remaining free space. Returns NULL if no binned region fits. Must be
+ * called with the lock held. */
+static void* _gc_arena_bin_malloc(GCArena arena, size_t size, size_t align)
+{
+    size_t bin = (ARENA_BIN_COUNT - 1) -
+        __builtin_clzll((unsigned long long)size);
 
-    void* alloc_addr = curr_region->_mem_pool + curr_region->_used_cap;
-    curr_region->_used_cap += size;
+    for(; bin < ARENA_BIN_COUNT; bin++)
+    {
+        if(!(arena->_bin_mask & ((uint64_t)1 << bin))) continue;
 
-    GC_RETURN(alloc_addr, out_status, GC_SUCCESS);
+        size_t scanned = 0;
+        Region* it = arena->_bins[bin];
+        for(; (it != NULL) && (scanned < ARENA_BIN_SCAN); it = it->_bin_next)
+        {
+            size_t offset = _region_align_offset(it, REGION_USED(it), align);
+
+            if(_region_fits(it, offset, size))
+            {
+                _gc_arena_unbin(arena, it);
+
+                REGION_SET_USED(it, offset + size);
+
+                _gc_arena_bin(arena, it);
+
+                return it->_mem_pool + offset;
+            }
+
+            scanned++;
+        }
+    }
+
+    return NULL;
+}
+
+/* Updates the peak usage with the arena's current usage. Must be called with
+ * the lock held. */
+static void _gc_arena_sample_peak(GCArena arena)
+{
+    size_t used = 0;
+
+    Region* it = arena->_regions._head;
+    for(; it != NULL; it = it->_next)
+        used += atomic_load_explicit(&it->_used_cap, memory_order_relaxed);
+
+    for(it = arena->_large._head; it != NULL; it = it->_next)
+        used += REGION_USED(it);
+
+    if(used > arena->_stats.peak_usage)
+        arena->_stats.peak_usage = used;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void* _arena_allocator_alloc(size_t size, void* context)
+{
+    return gc_arena_malloc((GCArena)context, size, NULL);
+}
+
+static void* _arena_allocator_realloc(void* ptr, size_t old_size,
+        size_t new_size, void* context)
+{
+    if(new_size == 0) return ptr;
+
+    return gc_arena_realloc((GCArena)context, ptr, old_size, new_size, NULL);
+}
+
+static void _arena_allocator_free(void* ptr, size_t size, void* context)
+{
+}
+
+struct GCAllocator gc_arena_allocator(GCArena arena)
+{
+    struct GCAllocator allocator = {
+        .alloc = _arena_allocator_alloc,
+        .realloc = _arena_allocator_realloc,
+        .free = _arena_allocator_free,
+        .context = arena
+    };
+
+    return allocator;
+}
+
+/* -------------------------------------------------------------------------- */
+
+GCArena gc_arena_create_file(const char* path, size_t size,
+        gc_status* out_status)
+{
+    if((path == NULL) || (size <= ARENA_IMAGE_HEADER))
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_ARENA_IO);
+    }
+
+    if(ftruncate(fd, (off_t)size) != 0)
+    {
+        close(fd);
+        GC_RETURN(NULL, out_status, GC_ERR_ARENA_IO);
+    }
+
+    void* image = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if(image == MAP_FAILED)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_ARENA_IO);
+    }
+
+    struct ArenaImageHeader* header = (struct ArenaImageHeader*)image;
+    memcpy(header->_magic, ARENA_IMAGE_MAGIC, sizeof(header->_magic));
+    header->_version = ARENA_IMAGE_VERSION;
+    header->_byte_order = ARENA_IMAGE_BYTE_ORDER;
+    header->_size = size;
+    header->_used = 0;
+    header->_root = 0;
+
+    gc_status _status;
+    GCArena new = _gc_arena_create_image(image, size, 0, false, &_status);
+
+    if(_status != GC_SUCCESS)
+    {
+        munmap(image, size);
+        GC_RETURN(NULL, out_status, _status);
+    }
+
+    GC_RETURN(new, out_status, GC_SUCCESS);
+}
+
+GCArena gc_arena_open(const char* path, int flags, gc_status* out_status)
+{
+    if(path == NULL)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    bool readonly = (flags & GC_ARENA_OPEN_READONLY);
+
+    int fd = open(path, readonly ? O_RDONLY : O_RDWR);
+    if(fd < 0)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_ARENA_IO);
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) != 0)
+    {
+        close(fd);
+        GC_RETURN(NULL, out_status, GC_ERR_ARENA_IO);
+    }
+
+    size_t size = (size_t)st.st_size;
+    if(size <= ARENA_IMAGE_HEADER)
+    {
+        close(fd);
+        GC_RETURN(NULL, out_status, GC_ERR_ARENA_BAD_IMAGE);
+    }
+
+    void* image = mmap(NULL, size,
+            readonly ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+    close(fd);
+
+    if(image == MAP_FAILED)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_ARENA_IO);
+    }
+
+    const struct ArenaImageHeader* header = (struct ArenaImageHeader*)image;
+    size_t pool_cap = size - ARENA_IMAGE_HEADER;
+
+    gc_status _status = GC_SUCCESS;
+    if((memcmp(header->_magic, ARENA_IMAGE_MAGIC,
+                    sizeof(header->_magic)) != 0) ||
+            (header->_byte_order != ARENA_IMAGE_BYTE_ORDER))
+        _status = GC_ERR_ARENA_BAD_IMAGE;
+    else if(header->_version != ARENA_IMAGE_VERSION)
+        _status = GC_ERR_ARENA_IMAGE_VERSION;
+    else if((header->_size != size) || (header->_used > pool_cap) ||
+            ((header->_root != 0) && ((header->_root < ARENA_IMAGE_HEADER) ||
+                (header->_root >= ARENA_IMAGE_HEADER + header->_used))))
+        _status = GC_ERR_ARENA_BAD_IMAGE;
+
+    GCArena new = NULL;
+    if(_status == GC_SUCCESS)
+        new = _gc_arena_create_image(image, size, header->_used, readonly,
+                &_status);
+
+    if(_status != GC_SUCCESS)
+    {
+        munmap(image, size);
+        GC_RETURN(NULL, out_status, _status);
+    }
+
+    GC_RETURN(new, out_status, GC_SUCCESS);
+}
+
+void gc_arena_save(GCArena arena, const void* root, gc_status* out_status)
+{
+    if((arena == NULL) || (arena->_image == NULL) || arena->_image_readonly)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    ARENA_LOCK(arena);
+
+    Region* region = arena->_regions._head;
+    size_t used = atomic_load_explicit(&region->_used_cap,
+            memory_order_relaxed);
+
+    uintptr_t addr = (uintptr_t)root;
+    uintptr_t pool = (uintptr_t)region->_mem_pool;
+    if((root != NULL) && ((addr < pool) || (addr - pool >= used)))
+    {
+        ARENA_UNLOCK(arena);
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    struct ArenaImageHeader* header = (struct ArenaImageHeader*)arena->_image;
+    header->_used = used;
+    header->_root = (root != NULL) ?
+        (uint64_t)(addr - (uintptr_t)arena->_image) : 0;
+
+    int ret = msync(arena->_image, arena->_image_size, MS_SYNC);
+
+    ARENA_UNLOCK(arena);
+
+    GC_VRETURN(out_status, (ret == 0) ? GC_SUCCESS : GC_ERR_ARENA_IO);
+}
+
+void* gc_arena_root(GCArena arena, gc_status* out_status)
+{
+    if((arena == NULL) || (arena->_image == NULL))
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    const struct ArenaImageHeader* header =
+        (struct ArenaImageHeader*)arena->_image;
+
+    void* root = (header->_root != 0) ? arena->_image + header->_root : NULL;
+
+    GC_RETURN(root, out_status, GC_SUCCESS);
+}
+
+uint64_t gc_arena_offset(GCArena arena, const void* ptr)
+{
+    return (ptr != NULL) ? (uint64_t)((const char*)ptr - arena->_image) : 0;
+}
+
+void* gc_arena_ptr(GCArena arena, uint64_t offset)
+{
+    return (offset != 0) ? arena->_image + offset : NULL;
+}
+
+/* Creates an arena whose only region is the memory pool of a mapped image.
+ * On failure, the caller still owns the mapping. */
+static GCArena _gc_arena_create_image(char* image, size_t image_size,
+        size_t used, bool readonly, gc_status* out_status)
+{
+    size_t pool_cap = image_size - ARENA_IMAGE_HEADER;
+
+    Region* region = _region_wrap(image + ARENA_IMAGE_HEADER, pool_cap);
+    if(region == NULL)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    GCArena new = (GCArena)malloc(sizeof(struct GCArena));
+    if(new == NULL)
+    {
+        _region_destroy(region);
+        GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    struct GCArenaOptions options = {0};
+    options.max_region_cap = pool_cap;
+    options.thread_cache_cap = pool_cap / THREAD_CACHE_DEFAULT_DIV;
+    if(options.thread_cache_cap == 0)
+        options.thread_cache_cap = 1;
+    new->_options = options;
+
+    _gc_arena_init(new, pool_cap, region, NULL);
+
+    // a read-only arena is full - allocations fail instead of writing
+    REGION_SET_USED(region, readonly ? pool_cap : used);
+
+    new->_image = image;
+    new->_image_size = image_size;
+    new->_image_readonly = readonly;
+
+    pthread_mutex_init(&new->_lock, NULL);
+
+    GC_RETURN(new, out_status, GC_SUCCESS);
 }
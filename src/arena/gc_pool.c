@@ -0,0 +1,508 @@
+#include "arena/gc_pool.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "_gc_shared.h"
+
+#define POOL_DEFAULT_ALIGN _Alignof(max_align_t)
+#define POOL_DEFAULT_SLAB_SIZE 16384
+
+#define POOL_MAGAZINE_DEFAULT 32
+#define POOL_MAGAZINE_MAX 64
+#define POOL_MAGAZINE_SLOTS 8
+
+/* A free object. The link to the next free object is stored inside the
+ * object itself. */
+struct PoolObject
+{
+    struct PoolObject* _next;
+};
+
+struct GCPool
+{
+    GCArena _arena;
+
+    /* Distance between neighbouring objects inside a slab - 'obj_size'
+     * rounded up to a multiple of '_align'. */
+    size_t _stride;
+    size_t _align;
+    size_t _slab_objects;
+
+    struct GCPoolOptions _options;
+
+    struct PoolObject* _free_list;
+
+    /* Objects in the current slab that were never handed out. */
+    char* _slab_pos;
+    char* _slab_end;
+
+    /* Unique across all pools and changed by gc_pool_reset(), like the
+     * arena's epoch. Magazines are tagged with it. */
+    _Atomic uint64_t _id;
+
+    pthread_mutex_t _lock;
+
+    /* Links inside the list of live pools(see _pool_registry). */
+    GCPool _prev;
+    GCPool _next;
+};
+
+/* Assumes that the pool's lock is held. */
+static inline void _pool_put(GCPool pool, void* obj)
+{
+    struct PoolObject* _obj = (struct PoolObject*)obj;
+
+    _obj->_next = pool->_free_list;
+    pool->_free_list = _obj;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Per-thread magazines(GC_POOL_THREAD_CACHE). Each thread has a small table
+ * of magazines - a pool's magazine is kept in the pool's home slot or, if
+ * that one is taken, in any other slot. A magazine is valid only if both the
+ * pool and the pool's id match.
+ *
+ * A magazine that has to give up its slot(the table is full) or whose thread
+ * exits is drained back into its pool, unless the pool was destroyed or reset
+ * in the meantime. */
+
+struct Magazine
+{
+    GCPool _pool;
+    uint64_t _id;
+
+    size_t _count;
+    void* _objs[POOL_MAGAZINE_MAX];
+};
+
+static _Thread_local struct Magazine _magazines[POOL_MAGAZINE_SLOTS];
+
+/* Drains a thread's magazines when the thread exits. The key's value is only
+ * set so that the destructor runs - it is the thread's '_magazines'. */
+static pthread_key_t _magazine_key;
+static pthread_once_t _magazine_key_once = PTHREAD_ONCE_INIT;
+
+/* List of live pools. A magazine may outlive its pool, so it is drained only
+ * if its pool is still on the list - the registry lock is held while
+ * draining, so the pool can not be destroyed meanwhile. Lock order: registry
+ * lock, then pool's lock. */
+static pthread_mutex_t _registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static GCPool _pool_registry = NULL;
+
+/* 0 is never handed out, so a zero-initialized Magazine is never valid. */
+static _Atomic uint64_t _id_counter = 1;
+
+#define MAGAZINE_HOME(pool) \
+    (((uintptr_t)(pool) >> 4) % POOL_MAGAZINE_SLOTS)
+
+static void _pool_next_id(GCPool pool)
+{
+    atomic_store_explicit(&pool->_id,
+            atomic_fetch_add(&_id_counter, 1), memory_order_release);
+}
+
+/* Returns the objects cached in 'mag' to its pool(if the pool is still live
+ * and was not reset) and empties the slot. */
+static void _magazine_flush(struct Magazine* mag)
+{
+    if((mag->_pool != NULL) && (mag->_count > 0))
+    {
+        pthread_mutex_lock(&_registry_lock);
+
+        GCPool it = _pool_registry;
+        while((it != NULL) && (it != mag->_pool))
+            it = it->_next;
+
+        if(it != NULL)
+        {
+            pthread_mutex_lock(&it->_lock);
+
+            // a pool created at a freed pool's address has a different id
+            if(atomic_load_explicit(&it->_id, memory_order_relaxed) ==
+                    mag->_id)
+            {
+                while(mag->_count > 0)
+                    _pool_put(it, mag->_objs[--mag->_count]);
+            }
+
+            pthread_mutex_unlock(&it->_lock);
+        }
+
+        pthread_mutex_unlock(&_registry_lock);
+    }
+
+    mag->_pool = NULL;
+    mag->_id = 0;
+    mag->_count = 0;
+}
+
+static void _magazine_destroy(void* magazines)
+{
+    struct Magazine* _mags = (struct Magazine*)magazines;
+
+    size_t i;
+    for(i = 0; i < POOL_MAGAZINE_SLOTS; i++)
+        _magazine_flush(&_mags[i]);
+}
+
+static void _magazine_key_create(void)
+{
+    pthread_key_create(&_magazine_key, _magazine_destroy);
+}
+
+/* Moves the magazine of 'pool' into the pool's home slot. If the thread has
+ * none, an empty one is created there - the home slot's previous magazine is
+ * moved to a free slot or, if the table is full, drained. Kept out of line,
+ * so that the acquire/release fast path stays small. */
+__attribute__((noinline))
+static struct Magazine* _pool_magazine_slow(GCPool pool, uint64_t id)
+{
+    size_t home = MAGAZINE_HOME(pool);
+    struct Magazine* mag = &_magazines[home];
+    struct Magazine* free_slot = NULL;
+
+    size_t i;
+    for(i = 1; i < POOL_MAGAZINE_SLOTS; i++)
+    {
+        struct Magazine* it = &_magazines[(home + i) % POOL_MAGAZINE_SLOTS];
+
+        if(it->_pool == pool)
+        {
+            struct Magazine tmp = *mag;
+            *mag = *it;
+            *it = tmp;
+
+            if(mag->_id != id)
+            {
+                mag->_id = id;
+                mag->_count = 0;
+            }
+
+            return mag;
+        }
+
+        if((it->_pool == NULL) && (free_slot == NULL))
+            free_slot = it;
+    }
+
+    if(mag->_pool != NULL)
+    {
+        if(free_slot != NULL)
+            *free_slot = *mag;
+        else
+            _magazine_flush(mag);
+    }
+
+    pthread_once(&_magazine_key_once, _magazine_key_create);
+    pthread_setspecific(_magazine_key, _magazines);
+
+    mag->_pool = pool;
+    mag->_id = id;
+    mag->_count = 0;
+
+    return mag;
+}
+
+/* Returns the magazine of 'pool' for the calling thread. A magazine left over
+ * from before the pool was reset is emptied. */
+static inline struct Magazine* _pool_magazine(GCPool pool)
+{
+    struct Magazine* mag = &_magazines[MAGAZINE_HOME(pool)];
+
+    uint64_t id = atomic_load_explicit(&pool->_id, memory_order_acquire);
+
+    if(mag->_pool != pool)
+        return _pool_magazine_slow(pool, id);
+
+    if(mag->_id != id)
+    {
+        mag->_id = id;
+        mag->_count = 0;
+    }
+
+    return mag;
+}
+
+/* Empties the calling thread's magazine of 'pool', if it has one. The objects
+ * are not returned to the pool. */
+static void _pool_magazine_forget(GCPool pool)
+{
+    size_t i;
+    for(i = 0; i < POOL_MAGAZINE_SLOTS; i++)
+    {
+        if(_magazines[i]._pool == pool)
+            _magazines[i] = (struct Magazine) {0};
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Assumes that the pool's lock is held. */
+static void* _pool_take(GCPool pool, gc_status* out_status)
+{
+    struct PoolObject* obj = pool->_free_list;
+    if(obj != NULL)
+    {
+        pool->_free_list = obj->_next;
+        GC_RETURN(obj, out_status, GC_SUCCESS);
+    }
+
+    if(pool->_slab_pos == pool->_slab_end)
+    {
+        size_t slab_size = pool->_stride * pool->_slab_objects;
+
+        gc_status _status;
+        char* slab = gc_arena_malloc_aligned(pool->_arena, slab_size,
+                pool->_align, &_status);
+
+        if(_status != GC_SUCCESS)
+        {
+            GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+        }
+
+        pool->_slab_pos = slab;
+        pool->_slab_end = slab + slab_size;
+    }
+
+    void* ret = pool->_slab_pos;
+    pool->_slab_pos += pool->_stride;
+
+    GC_RETURN(ret, out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void* _magazine_acquire(GCPool pool, gc_status* out_status)
+{
+    struct Magazine* mag = _pool_magazine(pool);
+
+    if(mag->_count > 0)
+    {
+        GC_RETURN(mag->_objs[--mag->_count], out_status, GC_SUCCESS);
+    }
+
+    // empty magazine - refill half of it under the lock
+    size_t refill = pool->_options.magazine_size / 2;
+    if(refill == 0) refill = 1;
+
+    gc_status _status = GC_SUCCESS;
+
+    pthread_mutex_lock(&pool->_lock);
+
+    while(mag->_count < refill)
+    {
+        void* obj = _pool_take(pool, &_status);
+        if(obj == NULL) break;
+
+        mag->_objs[mag->_count++] = obj;
+    }
+
+    pthread_mutex_unlock(&pool->_lock);
+
+    if(mag->_count == 0)
+    {
+        GC_RETURN(NULL, out_status, _status);
+    }
+
+    GC_RETURN(mag->_objs[--mag->_count], out_status, GC_SUCCESS);
+}
+
+static void _magazine_release(GCPool pool, void* obj)
+{
+    struct Magazine* mag = _pool_magazine(pool);
+
+    // full magazine - drain half of it under the lock
+    if(mag->_count == pool->_options.magazine_size)
+    {
+        size_t drain = (mag->_count + 1) / 2;
+
+        pthread_mutex_lock(&pool->_lock);
+
+        while(drain > 0)
+        {
+            _pool_put(pool, mag->_objs[--mag->_count]);
+            drain--;
+        }
+
+        pthread_mutex_unlock(&pool->_lock);
+    }
+
+    mag->_objs[mag->_count++] = obj;
+}
+
+/* -------------------------------------------------------------------------- */
+
+GCPool gc_pool_create(GCArena arena, size_t obj_size, size_t align,
+        gc_status* out_status)
+{
+    struct GCPoolOptions options = {0};
+
+    return gc_pool_create_(arena, obj_size, align, options, out_status);
+}
+
+GCPool gc_pool_create_(GCArena arena, size_t obj_size, size_t align,
+        struct GCPoolOptions options, gc_status* out_status)
+{
+    if((arena == NULL) || (obj_size == 0))
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    if(align == 0)
+        align = POOL_DEFAULT_ALIGN;
+    else if((align & (align - 1)) != 0)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    if(align < _Alignof(struct PoolObject))
+        align = _Alignof(struct PoolObject);
+    if(obj_size < sizeof(struct PoolObject))
+        obj_size = sizeof(struct PoolObject);
+
+    if(obj_size > SIZE_MAX - align)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    size_t stride = (obj_size + (align - 1)) & ~(align - 1);
+
+    if(options.slab_objects == 0)
+    {
+        options.slab_objects = POOL_DEFAULT_SLAB_SIZE / stride;
+        if(options.slab_objects == 0) options.slab_objects = 1;
+    }
+    if(options.slab_objects > SIZE_MAX / stride)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    if(options.magazine_size == 0)
+        options.magazine_size = POOL_MAGAZINE_DEFAULT;
+    else if(options.magazine_size > POOL_MAGAZINE_MAX)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    GCPool pool = (GCPool)malloc(sizeof(struct GCPool));
+    if(pool == NULL)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    pool->_arena = arena;
+    pool->_stride = stride;
+    pool->_align = align;
+    pool->_slab_objects = options.slab_objects;
+    pool->_options = options;
+    pool->_free_list = NULL;
+    pool->_slab_pos = NULL;
+    pool->_slab_end = NULL;
+    _pool_next_id(pool);
+    pthread_mutex_init(&pool->_lock, NULL);
+
+    pthread_mutex_lock(&_registry_lock);
+
+    pool->_prev = NULL;
+    pool->_next = _pool_registry;
+    if(_pool_registry != NULL) _pool_registry->_prev = pool;
+    _pool_registry = pool;
+
+    pthread_mutex_unlock(&_registry_lock);
+
+    GC_RETURN(pool, out_status, GC_SUCCESS);
+}
+
+void gc_pool_destroy(GCPool pool, gc_status* out_status)
+{
+    if(pool == NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    pthread_mutex_lock(&_registry_lock);
+
+    if(pool->_prev != NULL) pool->_prev->_next = pool->_next;
+    else _pool_registry = pool->_next;
+    if(pool->_next != NULL) pool->_next->_prev = pool->_prev;
+
+    pthread_mutex_unlock(&_registry_lock);
+
+    if(pool->_options.flags & GC_POOL_THREAD_CACHE)
+        _pool_magazine_forget(pool);
+
+    pool->_free_list = NULL;
+    pool->_slab_pos = NULL;
+    pool->_slab_end = NULL;
+    pthread_mutex_destroy(&pool->_lock);
+    free(pool);
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void* gc_pool_acquire(GCPool pool, gc_status* out_status)
+{
+    if(pool == NULL)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    if(pool->_options.flags & GC_POOL_THREAD_CACHE)
+        return _magazine_acquire(pool, out_status);
+
+    gc_status _status;
+
+    pthread_mutex_lock(&pool->_lock);
+    void* obj = _pool_take(pool, &_status);
+    pthread_mutex_unlock(&pool->_lock);
+
+    GC_RETURN(obj, out_status, _status);
+}
+
+void gc_pool_release(GCPool pool, void* obj, gc_status* out_status)
+{
+    if((pool == NULL) || (obj == NULL))
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    if(pool->_options.flags & GC_POOL_THREAD_CACHE)
+    {
+        _magazine_release(pool, obj);
+        GC_VRETURN(out_status, GC_SUCCESS);
+    }
+
+    pthread_mutex_lock(&pool->_lock);
+    _pool_put(pool, obj);
+    pthread_mutex_unlock(&pool->_lock);
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void gc_pool_reset(GCPool pool, gc_status* out_status)
+{
+    if(pool == NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    pthread_mutex_lock(&pool->_lock);
+
+    pool->_free_list = NULL;
+    pool->_slab_pos = NULL;
+    pool->_slab_end = NULL;
+    _pool_next_id(pool);
+
+    pthread_mutex_unlock(&pool->_lock);
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
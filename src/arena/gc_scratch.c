@@ -0,0 +1,110 @@
+#include "arena/gc_scratch.h"
+
+#include <pthread.h>
+#include <stddef.h>
+
+#include "_gc_shared.h"
+
+#define SCRATCH_REGION_CAP 65536
+#define SCRATCH_ARENA_COUNT 2
+
+/* The calling thread's scratch arenas, NULL until first used. */
+static _Thread_local GCArena _scratch_arenas[SCRATCH_ARENA_COUNT];
+
+/* Destroys a thread's scratch arenas when the thread exits. The key's value
+ * is only set so that the destructor runs - it is the thread's
+ * '_scratch_arenas'. */
+static pthread_key_t _scratch_key;
+static pthread_once_t _scratch_key_once = PTHREAD_ONCE_INIT;
+
+static void _scratch_destroy(void* arenas)
+{
+    GCArena* _arenas = (GCArena*)arenas;
+
+    size_t i;
+    for(i = 0; i < SCRATCH_ARENA_COUNT; i++)
+    {
+        if(_arenas[i] != NULL)
+        {
+            gc_arena_destroy(_arenas[i], NULL);
+            _arenas[i] = NULL;
+        }
+    }
+}
+
+static void _scratch_key_create(void)
+{
+    pthread_key_create(&_scratch_key, _scratch_destroy);
+}
+
+/* Returns the calling thread's scratch arena 'i', creating it if needed. */
+static GCArena _scratch_arena(size_t i, gc_status* out_status)
+{
+    if(_scratch_arenas[i] != NULL)
+    {
+        GC_RETURN(_scratch_arenas[i], out_status, GC_SUCCESS);
+    }
+
+    struct GCArenaOptions options = {
+        .flags = GC_ARENA_SINGLE_THREAD,
+        .growth_policy = GC_ARENA_GROWTH_GEOMETRIC
+    };
+
+    gc_status _status;
+    GCArena new = gc_arena_create_(SCRATCH_REGION_CAP, options, &_status);
+
+    if(_status != GC_SUCCESS)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    pthread_once(&_scratch_key_once, _scratch_key_create);
+    pthread_setspecific(_scratch_key, _scratch_arenas);
+
+    _scratch_arenas[i] = new;
+
+    GC_RETURN(new, out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+GCScratch gc_scratch_begin(GCArena conflict, gc_status* out_status)
+{
+    GCScratch scratch = {0};
+
+    size_t i = ((conflict != NULL) && (conflict == _scratch_arenas[0])) ? 1 : 0;
+
+    gc_status _status;
+    GCArena arena = _scratch_arena(i, &_status);
+
+    if(_status != GC_SUCCESS)
+    {
+        GC_RETURN(scratch, out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    scratch.arena = arena;
+    scratch._mark = gc_arena_mark(arena, NULL);
+
+    GC_RETURN(scratch, out_status, GC_SUCCESS);
+}
+
+void gc_scratch_end(GCScratch scratch, gc_status* out_status)
+{
+    if(scratch.arena == NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    gc_arena_rewind_to(scratch.arena, scratch._mark, NULL);
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void gc_scratch_release(gc_status* out_status)
+{
+    _scratch_destroy(_scratch_arenas);
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
@@ -0,0 +1,335 @@
+#define _GNU_SOURCE
+
+#include "arena/gc_sharded_arena.h"
+
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <unistd.h>
+
+#include "_gc_shared.h"
+
+struct GCShardedArena
+{
+    /* NULL until first selected. Installed with a CAS, so two threads racing
+     * to create the same shard end up using the same one. */
+    _Atomic(GCArena)* _shards;
+    size_t _shard_count;
+
+    size_t _region_cap;
+    struct GCShardedArenaOptions _options;
+};
+
+/* GC_SHARDED_ARENA_BY_THREAD - index of the calling thread, 0 if not assigned
+ * yet. */
+static _Thread_local size_t _thread_index = 0;
+static _Atomic size_t _thread_index_counter = 1;
+
+static size_t _sharded_arena_thread_index(void)
+{
+    if(_thread_index == 0)
+        _thread_index = atomic_fetch_add(&_thread_index_counter, 1);
+
+    return _thread_index;
+}
+
+static size_t _sharded_arena_select(GCShardedArena arena)
+{
+    if(arena->_options.shard_policy == GC_SHARDED_ARENA_BY_CPU)
+    {
+        int cpu = sched_getcpu();
+
+        if(cpu >= 0)
+            return (size_t)cpu % arena->_shard_count;
+    }
+
+    return _sharded_arena_thread_index() % arena->_shard_count;
+}
+
+/* Returns the calling thread's shard, creating it if needed. */
+static GCArena _sharded_arena_shard(GCShardedArena arena,
+        gc_status* out_status)
+{
+    _Atomic(GCArena)* slot = &arena->_shards[_sharded_arena_select(arena)];
+
+    GCArena shard = atomic_load_explicit(slot, memory_order_acquire);
+    if(shard != NULL)
+    {
+        GC_RETURN(shard, out_status, GC_SUCCESS);
+    }
+
+    gc_status _status;
+    GCArena new = gc_arena_create_(arena->_region_cap,
+            arena->_options.arena_options, &_status);
+
+    if(_status != GC_SUCCESS)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    if(!atomic_compare_exchange_strong_explicit(slot, &shard, new,
+                memory_order_acq_rel, memory_order_acquire))
+    {
+        // another thread installed the shard first
+        gc_arena_destroy(new, NULL);
+        GC_RETURN(shard, out_status, GC_SUCCESS);
+    }
+
+    GC_RETURN(new, out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+GCShardedArena gc_sharded_arena_create(size_t region_cap,
+        gc_status* out_status)
+{
+    struct GCShardedArenaOptions options = {0};
+
+    return gc_sharded_arena_create_(region_cap, options, out_status);
+}
+
+GCShardedArena gc_sharded_arena_create_(size_t region_cap,
+        struct GCShardedArenaOptions options, gc_status* out_status)
+{
+    if((options.shard_policy != GC_SHARDED_ARENA_BY_CPU) &&
+            (options.shard_policy != GC_SHARDED_ARENA_BY_THREAD))
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    // several threads can end up on the same shard
+    if(options.arena_options.flags & GC_ARENA_SINGLE_THREAD)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    if(options.shard_count == 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_CONF);
+        options.shard_count = (cpus > 0) ? (size_t)cpus : 1;
+    }
+    else if(options.shard_count > SIZE_MAX / sizeof(_Atomic(GCArena)))
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    GCShardedArena new = (GCShardedArena)malloc(sizeof(struct GCShardedArena));
+    if(new == NULL)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    new->_shards = (_Atomic(GCArena)*)malloc(options.shard_count *
+            sizeof(_Atomic(GCArena)));
+    if(new->_shards == NULL)
+    {
+        free(new);
+        GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    /* The first shard is created right away, so that invalid arena options
+     * are reported here rather than by the first allocation. */
+    gc_status _status;
+    GCArena first = gc_arena_create_(region_cap, options.arena_options,
+            &_status);
+
+    if(_status != GC_SUCCESS)
+    {
+        free(new->_shards);
+        free(new);
+        GC_RETURN(NULL, out_status,
+                (_status == GC_ERR_INVALID_ARG) ? GC_ERR_INVALID_ARG :
+                GC_ERR_ALLOC_FAIL);
+    }
+
+    atomic_init(&new->_shards[0], first);
+
+    size_t i;
+    for(i = 1; i < options.shard_count; i++)
+        atomic_init(&new->_shards[i], NULL);
+
+    new->_shard_count = options.shard_count;
+    new->_region_cap = region_cap;
+    new->_options = options;
+
+    GC_RETURN(new, out_status, GC_SUCCESS);
+}
+
+void gc_sharded_arena_destroy(GCShardedArena arena, gc_status* out_status)
+{
+    if(arena == NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    size_t i;
+    for(i = 0; i < arena->_shard_count; i++)
+    {
+        GCArena shard = atomic_load(&arena->_shards[i]);
+        if(shard != NULL) gc_arena_destroy(shard, NULL);
+    }
+
+    free(arena->_shards);
+    arena->_shards = NULL;
+    arena->_shard_count = 0;
+    free(arena);
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+GCArena gc_sharded_arena_shard(GCShardedArena arena, gc_status* out_status)
+{
+    if(arena == NULL)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    return _sharded_arena_shard(arena, out_status);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void* gc_sharded_arena_malloc(GCShardedArena arena, size_t size,
+        gc_status* out_status)
+{
+    GCArena shard = gc_sharded_arena_shard(arena, out_status);
+    if(shard == NULL) return NULL;
+
+    return gc_arena_malloc(shard, size, out_status);
+}
+
+void* gc_sharded_arena_malloc_aligned(GCShardedArena arena, size_t size,
+        size_t align, gc_status* out_status)
+{
+    GCArena shard = gc_sharded_arena_shard(arena, out_status);
+    if(shard == NULL) return NULL;
+
+    return gc_arena_malloc_aligned(shard, size, align, out_status);
+}
+
+void* gc_sharded_arena_calloc(GCShardedArena arena, size_t size,
+        gc_status* out_status)
+{
+    GCArena shard = gc_sharded_arena_shard(arena, out_status);
+    if(shard == NULL) return NULL;
+
+    return gc_arena_calloc(shard, size, out_status);
+}
+
+void* gc_sharded_arena_realloc(GCShardedArena arena, void* ptr,
+        size_t old_size, size_t new_size, gc_status* out_status)
+{
+    GCArena shard = gc_sharded_arena_shard(arena, out_status);
+    if(shard == NULL) return NULL;
+
+    return gc_arena_realloc(shard, ptr, old_size, new_size, out_status);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void gc_sharded_arena_rewind(GCShardedArena arena, gc_status* out_status)
+{
+    if(arena == NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    size_t i;
+    for(i = 0; i < arena->_shard_count; i++)
+    {
+        GCArena shard = atomic_load(&arena->_shards[i]);
+        if(shard != NULL) gc_arena_rewind(shard, NULL);
+    }
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+void gc_sharded_arena_reset(GCShardedArena arena, gc_status* out_status)
+{
+    if(arena == NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    size_t i;
+    for(i = 0; i < arena->_shard_count; i++)
+    {
+        GCArena shard = atomic_load(&arena->_shards[i]);
+        if(shard != NULL) gc_arena_reset(shard, NULL);
+    }
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+struct GCArenaStats gc_sharded_arena_stats(GCShardedArena arena,
+        gc_status* out_status)
+{
+    struct GCArenaStats total = {0};
+
+    if(arena == NULL)
+    {
+        GC_RETURN(total, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    size_t i;
+    for(i = 0; i < arena->_shard_count; i++)
+    {
+        GCArena shard = atomic_load(&arena->_shards[i]);
+        if(shard == NULL) continue;
+
+        struct GCArenaStats stats = gc_arena_stats(shard, NULL);
+
+        total.region_count += stats.region_count;
+        total.large_region_count += stats.large_region_count;
+        total.bytes_reserved += stats.bytes_reserved;
+        total.cached_region_count += stats.cached_region_count;
+        total.bytes_cached += stats.bytes_cached;
+        total.bytes_used += stats.bytes_used;
+        total.tail_waste += stats.tail_waste;
+        // sum of per-shard peaks - an upper bound, see the header
+        total.peak_usage += stats.peak_usage;
+        total.rewind_count += stats.rewind_count;
+        total.region_allocs += stats.region_allocs;
+        total.lock_acquisitions += stats.lock_acquisitions;
+        total.lock_contentions += stats.lock_contentions;
+    }
+
+    GC_RETURN(total, out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void* _sharded_allocator_alloc(size_t size, void* context)
+{
+    return gc_sharded_arena_malloc((GCShardedArena)context, size, NULL);
+}
+
+static void* _sharded_allocator_realloc(void* ptr, size_t old_size,
+        size_t new_size, void* context)
+{
+    if(new_size == 0) return ptr;
+
+    return gc_sharded_arena_realloc((GCShardedArena)context, ptr, old_size,
+            new_size, NULL);
+}
+
+static void _sharded_allocator_free(void* ptr, size_t size, void* context)
+{
+}
+
+struct GCAllocator gc_sharded_arena_allocator(GCShardedArena arena)
+{
+    struct GCAllocator allocator = {
+        .alloc = _sharded_allocator_alloc,
+        .realloc = _sharded_allocator_realloc,
+        .free = _sharded_allocator_free,
+        .context = arena
+    };
+
+    return allocator;
+}
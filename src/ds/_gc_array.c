@@ -1,12 +1,67 @@
+#define _GNU_SOURCE
+
 #include "_gc_shared.h"
 #include "ds/gc_array.h"
 #include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include "ds/_gc_array.h"
 
-void __gc_arr_init(struct __GCArray* array, size_t cap,
-        size_t el_size, gc_status* out_status)
+/* Size of the mapping holding a data field of 'size' bytes. */
+static size_t _arr_map_size(size_t size)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    return (size + (page - 1)) & ~(page - 1);
+}
+
+static inline bool _arr_mappable(const struct __GCArray* array, size_t size)
+{
+    return (size >= __GC_ARR_MMAP_THRESHOLD) &&
+        gc_allocator_is_default(&array->_allocator);
+}
+
+static void* _arr_map(size_t size)
+{
+    void* data = mmap(NULL, _arr_map_size(size), PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    return (data != MAP_FAILED) ? data : NULL;
+}
+
+/* Allocates a new data field of 'size' bytes - mapped or through the
+ * allocator. Sets array->_mapped accordingly on success. */
+static void* _arr_alloc_data(struct __GCArray* array, size_t size)
+{
+    bool mapped = _arr_mappable(array, size);
+
+    void* data = mapped ? _arr_map(size) :
+        gc_allocator_alloc(&array->_allocator, size);
+
+    if(data != NULL) array->_mapped = mapped;
+
+    return data;
+}
+
+/* Frees the data field. Assumes that it is not the inline storage. */
+static void _arr_free_data(struct __GCArray* array)
 {
-    array->_data = malloc(cap * el_size);
+    if(array->_mapped)
+        munmap(array->_data, _arr_map_size(array->_capacity * array->_el_size));
+    else
+        gc_allocator_free(&array->_allocator, array->_data,
+                array->_capacity * array->_el_size);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void __gc_arr_init(struct __GCArray* array, size_t cap, size_t el_size,
+        const struct GCAllocator* allocator, gc_status* out_status)
+{
+    array->_allocator = *allocator;
+    array->_mapped = false;
+    array->_inline_cap = 0;
+    array->_data = _arr_alloc_data(array, cap * el_size);
     if(array->_data == NULL) 
     {
         GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);   
@@ -19,13 +74,26 @@ void __gc_arr_init(struct __GCArray* array, size_t cap,
     GC_VRETURN(out_status, GC_SUCCESS);
 }
 
+void __gc_arr_init_inline(struct __GCArray* array, size_t inline_cap,
+        size_t el_size, const struct GCAllocator* allocator)
+{
+    array->_allocator = *allocator;
+    array->_mapped = false;
+    array->_inline_cap = inline_cap;
+    array->_data = __gc_arr_inline_data(array);
+    array->_size = 0;
+    array->_el_size = el_size;
+    array->_capacity = inline_cap;
+}
+
 void __gc_arr_destroy(struct __GCArray* array)
 {
-    if(array->_data != NULL)
-    {
-        free(array->_data);
-        array->_data = NULL;
-    }
+    if((array->_data != NULL) && !__gc_arr_is_inline(array))
+        _arr_free_data(array);
+
+    array->_data = NULL;
+
+    array->_mapped = false;
 
     array->_capacity = 0;
     array->_size = 0;
@@ -33,25 +101,103 @@ void __gc_arr_destroy(struct __GCArray* array)
 
 }
 
-void __gc_arr_insert(struct __GCArray* array, size_t pos, const void* data_arr,
-        size_t data_size)
+void* __gc_arr_realloc(struct __GCArray* array, size_t new_cap)
 {
-    if(data_size == 0) return;
+    size_t old_size = array->_capacity * array->_el_size;
+    size_t new_size = new_cap * array->_el_size;
 
-    void* start_pos = __gc_arr_at(array, pos);
+    void* new_data;
 
-    size_t bytes_inserted = data_size * array->_el_size;
+    if(__gc_arr_is_inline(array))
+    {
+        // still fits - the inline storage itself cannot shrink
+        if(new_cap <= array->_inline_cap) return array->_data;
+
+        // outgrown - spill to the heap
+        new_data = _arr_alloc_data(array, new_size);
+        if(new_data == NULL) return NULL;
+
+        memcpy(new_data, array->_data, old_size);
+
+        return new_data;
+    }
+
+    // shrunk enough to fit back into the inline storage(if there is one)
+    if((array->_inline_cap > 0) && (new_cap <= array->_inline_cap))
+    {
+        new_data = __gc_arr_inline_data(array);
+
+        memcpy(new_data, array->_data, new_size);
+        _arr_free_data(array);
+        array->_mapped = false;
+
+        return new_data;
+    }
+
+    if(array->_mapped)
+    {
+        // stays mapped - move the pages, do not copy them
+        if(new_size >= __GC_ARR_MMAP_THRESHOLD)
+        {
+            new_data = mremap(array->_data, _arr_map_size(old_size),
+                    _arr_map_size(new_size), MREMAP_MAYMOVE);
+
+            return (new_data != MAP_FAILED) ? new_data : NULL;
+        }
+
+        // shrunk below the threshold - back to the allocator
+        new_data = gc_allocator_alloc(&array->_allocator, new_size);
+        if(new_data == NULL) return NULL;
+
+        memcpy(new_data, array->_data, new_size);
+        _arr_free_data(array);
+        array->_mapped = false;
+
+        return new_data;
+    }
+
+    if(_arr_mappable(array, new_size))
+    {
+        new_data = _arr_map(new_size);
+        if(new_data == NULL) return NULL;
+
+        memcpy(new_data, array->_data,
+                (old_size < new_size) ? old_size : new_size);
+        _arr_free_data(array);
+        array->_mapped = true;
+
+        return new_data;
+    }
+
+    return gc_allocator_realloc(&array->_allocator, array->_data, old_size,
+            new_size);
+}
+
+void* __gc_arr_open(struct __GCArray* array, size_t pos, size_t count)
+{
+    void* start_pos = __gc_arr_at(array, pos);
 
     size_t elements_shifted = array->_size - pos;
-    if(elements_shifted > 0)
+    if((elements_shifted > 0) && (count > 0))
     {
         size_t bytes_shifted = elements_shifted * array->_el_size;
-        memmove(start_pos + bytes_inserted, start_pos, bytes_shifted);
+        memmove(start_pos + (count * array->_el_size), start_pos,
+                bytes_shifted);
     }
 
-    memcpy(start_pos, data_arr, bytes_inserted);
+    array->_size += count;
+
+    return start_pos;
+}
+
+void __gc_arr_insert(struct __GCArray* array, size_t pos, const void* data_arr,
+        size_t data_size)
+{
+    if(data_size == 0) return;
+
+    void* start_pos = __gc_arr_open(array, pos, data_size);
 
-    array->_size += data_size;
+    memcpy(start_pos, data_arr, data_size * array->_el_size);
 }
 
 void __gc_arr_remove(struct __GCArray* array, size_t start_pos,
@@ -2,12 +2,12 @@
 #include "_gc_shared.h"
 #include "ds/_gc_array.h"
 
-void __gc_vec_init(struct __GCVector* vec, size_t cap,
-        size_t el_size, gc_status* out_status)
+void __gc_vec_init(struct __GCVector* vec, size_t cap, size_t el_size,
+        const struct GCAllocator* allocator, gc_status* out_status)
 {
     gc_status _status;
 
-    __gc_arr_init((struct __GCArray*)vec, cap, el_size, &_status);
+    __gc_arr_init((struct __GCArray*)vec, cap, el_size, allocator, &_status);
 
     GC_VRETURN(out_status, _status);
 }
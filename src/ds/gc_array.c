@@ -5,12 +5,21 @@
 
 _GCArray _gc_arr_create(size_t capacity, size_t el_size, gc_status* out_status)
 {
-    if((capacity == 0) || (el_size == 0))
+    struct GCAllocator allocator = gc_allocator_default();
+
+    return _gc_arr_create_with(capacity, el_size, &allocator, out_status);
+}
+
+_GCArray _gc_arr_create_with(size_t capacity, size_t el_size,
+        const struct GCAllocator* allocator, gc_status* out_status)
+{
+    if((capacity == 0) || (el_size == 0) || (allocator == NULL))
     {
         GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
     }
 
-    _GCArray arr = (_GCArray)malloc(sizeof(struct __GCArray));
+    _GCArray arr = (_GCArray)gc_allocator_alloc(allocator,
+            sizeof(struct __GCArray));
 
     if(arr == NULL)
     {
@@ -18,17 +27,17 @@ _GCArray _gc_arr_create(size_t capacity, size_t el_size, gc_status* out_status)
     }
 
     gc_status _status;
-    __gc_arr_init(arr, capacity, el_size, &_status);
+    __gc_arr_init(arr, capacity, el_size, allocator, &_status);
 
     switch(_status)
     {
         case GC_SUCCESS:
             GC_RETURN(arr, out_status, GC_SUCCESS);
         case GC_ERR_ALLOC_FAIL:
-            free(arr);
+            gc_allocator_free(allocator, arr, sizeof(struct __GCArray));
             GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
         default:
-            free(arr);
+            gc_allocator_free(allocator, arr, sizeof(struct __GCArray));
             GC_RETURN(NULL, out_status, GC_ERR_UNHANDLED);
     }
 }
@@ -40,9 +49,12 @@ void gc_arr_destroy(_GCArray array, gc_status* out_status)
         GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
     }
 
+    struct GCAllocator allocator = array->_allocator;
+    size_t struct_size = __gc_arr_struct_size(array);
+
     __gc_arr_destroy(array);
 
-    free(array);
+    gc_allocator_free(&allocator, array, struct_size);
 
     GC_VRETURN(out_status, GC_SUCCESS);
 }
@@ -133,6 +145,73 @@ void _gc_arr_push_back(_GCArray array, const void* data, gc_status* out_status)
     }
 }
 
+void gc_arr_insert_n(_GCArray array, const void* data_arr, size_t count,
+        size_t pos, gc_status* out_status)
+{
+    if(array == NULL) 
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);   
+    }
+    if(pos > array->_size) 
+    {
+        GC_VRETURN(out_status, GC_ERR_OUT_OF_BOUNDS);   
+    }
+    if((data_arr == NULL) && (count > 0)) 
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);   
+    }
+
+    if(count > array->_capacity - array->_size) 
+    {
+        GC_VRETURN(out_status, GC_ERR_ARRAY_NO_CAP);   
+    }
+
+    __gc_arr_insert(array, pos, data_arr, count);
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+void gc_arr_append_n(_GCArray array, const void* data_arr, size_t count,
+        gc_status* out_status)
+{
+    if(array == NULL) 
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);   
+    }
+
+    gc_arr_insert_n(array, data_arr, count, array->_size, out_status);
+}
+
+void* gc_arr_emplace_at(_GCArray array, size_t pos, gc_status* out_status)
+{
+    if(array == NULL) 
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);   
+    }
+    if(pos > array->_size) 
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_OUT_OF_BOUNDS);   
+    }
+    if(array->_size >= array->_capacity) 
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_ARRAY_NO_CAP);   
+    }
+
+    void* slot = __gc_arr_open(array, pos, 1);
+
+    GC_RETURN(slot, out_status, GC_SUCCESS);
+}
+
+void* gc_arr_emplace_back(_GCArray array, gc_status* out_status)
+{
+    if(array == NULL) 
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);   
+    }
+
+    return gc_arr_emplace_at(array, array->_size, out_status);
+}
+
 void gc_arr_remove(_GCArray array, size_t pos, gc_status* out_status)
 {
     if(array == NULL) 
@@ -149,6 +228,45 @@ void gc_arr_remove(_GCArray array, size_t pos, gc_status* out_status)
     GC_VRETURN(out_status, GC_SUCCESS);
 }
 
+void gc_arr_remove_range(_GCArray array, size_t start_pos, size_t end_pos,
+        gc_status* out_status)
+{
+    if(array == NULL) 
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);   
+    }
+    if((start_pos > end_pos) || (end_pos > array->_size)) 
+    {
+        GC_VRETURN(out_status, GC_ERR_OUT_OF_BOUNDS);   
+    }
+
+    if(start_pos < end_pos)
+        __gc_arr_remove(array, start_pos, end_pos);
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+void gc_arr_swap_remove(_GCArray array, size_t pos, gc_status* out_status)
+{
+    if(array == NULL) 
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);   
+    }
+    if(pos >= array->_size) 
+    {
+        GC_VRETURN(out_status, GC_ERR_OUT_OF_BOUNDS);   
+    }
+
+    size_t last = array->_size - 1;
+    if(pos != last)
+        memcpy(__gc_arr_at(array, pos), __gc_arr_at(array, last),
+                array->_el_size);
+
+    array->_size--;
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
 void gc_arr_pop_back(_GCArray array, gc_status* out_status)
 {
     if(array == NULL) 
@@ -179,7 +297,7 @@ void gc_arr_reserve(_GCArray array, size_t capacity, gc_status* out_status)
     }
     else
     {
-        void* new_data = realloc(array->_data, capacity * array->_el_size);
+        void* new_data = __gc_arr_realloc(array, capacity);
         if(new_data == NULL)
         {
             GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
@@ -205,7 +323,7 @@ void gc_arr_fit(_GCArray array, gc_status* out_status)
         GC_VRETURN(out_status, GC_SUCCESS);
     }
 
-    array->_data = realloc(array->_data, array->_size * array->_el_size);
+    array->_data = __gc_arr_realloc(array, array->_size);
 
     array->_capacity = array->_size;
 }
@@ -0,0 +1,374 @@
+#include "ds/gc_conc_vector.h"
+#include "_gc_shared.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Number of bits inside size_t - also the size of the chunk directory. */
+#define CVEC_BITS (sizeof(size_t) * 8)
+
+#define CVEC_CACHE_LINE 64
+
+struct GCConcVector
+{
+    /* reserved - next free slot. Incremented by every push_back. */
+    _Atomic size_t _reserved;
+    char _pad0[CVEC_CACHE_LINE - sizeof(size_t)];
+
+    /* size - published size. Slots below it are fully written. */
+    _Atomic size_t _size;
+    char _pad1[CVEC_CACHE_LINE - sizeof(size_t)];
+
+    /* limit - first slot that failed to get a chunk(SIZE_MAX if none did).
+     * The failed slot is never written, so the size never passes it. */
+    _Atomic size_t _limit;
+
+    /* el_size - size of single element(bytes) */
+    size_t _el_size;
+
+    /* base_shift - log2 of the first chunk's capacity. Chunk 'k' holds
+     * (1 << (base_shift + k)) elements. */
+    size_t _base_shift;
+
+    /* allocator - every allocation made by the vector(including the struct
+     * itself) goes through this allocator */
+    struct GCAllocator _allocator;
+
+    /* chunks - the chunk directory. Unlike GCSegVector's, it has a fixed size
+     * - growing it would move it under concurrent readers. NULL until the
+     * chunk is installed. A chunk holds its elements, followed by one ready
+     * flag per element. */
+    _Atomic(void*) _chunks[CVEC_BITS];
+};
+
+/* -------------------------------------------------------------------------- */
+
+/* Index of the highest set bit of 'x'. Assumes 'x' > 0. */
+static inline size_t _cvec_msb(size_t x)
+{
+    return (CVEC_BITS - 1) - __builtin_clzll((unsigned long long)x);
+}
+
+/* Size of chunk 'k'(bytes), ready flags included. */
+static inline size_t _cvec_chunk_size(const GCConcVector vector, size_t k)
+{
+    return ((size_t)1 << (vector->_base_shift + k)) * (vector->_el_size + 1);
+}
+
+/* Ready flag of element 'offset' inside chunk 'k'. */
+static inline _Atomic unsigned char* _cvec_ready(const GCConcVector vector,
+        char* chunk, size_t k, size_t offset)
+{
+    return (_Atomic unsigned char*)(chunk +
+            (((size_t)1 << (vector->_base_shift + k)) * vector->_el_size)) +
+        offset;
+}
+
+/* Returns true if 'slot' is written. */
+static bool _cvec_is_ready(const GCConcVector vector, size_t slot)
+{
+    size_t i = slot + ((size_t)1 << vector->_base_shift);
+    size_t msb = _cvec_msb(i);
+    size_t k = msb - vector->_base_shift;
+
+    char* chunk = atomic_load_explicit(&vector->_chunks[k],
+            memory_order_acquire);
+    if(chunk == NULL) return false;
+
+    return atomic_load(_cvec_ready(vector, chunk, k, i - ((size_t)1 << msb)));
+}
+
+/* Allocates and installs chunk 'k'. If the allocation fails, but another
+ * thread has installed the chunk in the meantime, that chunk is returned.
+ * ERRORS: GC_ERR_ALLOC_FAIL */
+static void* _cvec_install(GCConcVector vector, size_t k,
+        gc_status* out_status)
+{
+    if(((vector->_base_shift + k) >= (CVEC_BITS - 1)) ||
+            (((size_t)1 << (vector->_base_shift + k)) >
+             (SIZE_MAX / (vector->_el_size + 1))))
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    size_t size = _cvec_chunk_size(vector, k);
+
+    void* new = gc_allocator_alloc(&vector->_allocator, size);
+    if(new == NULL)
+    {
+        void* chunk = atomic_load(&vector->_chunks[k]);
+
+        GC_RETURN(chunk, out_status,
+                (chunk != NULL) ? GC_SUCCESS : GC_ERR_ALLOC_FAIL);
+    }
+
+    size_t cap = (size_t)1 << (vector->_base_shift + k);
+    memset((char*)new + (cap * vector->_el_size), 0, cap);
+
+    void* chunk = NULL;
+    if(!atomic_compare_exchange_strong(&vector->_chunks[k], &chunk, new))
+    {
+        // another thread installed the chunk first
+        gc_allocator_free(&vector->_allocator, new, size);
+        GC_RETURN(chunk, out_status, GC_SUCCESS);
+    }
+
+    GC_RETURN(new, out_status, GC_SUCCESS);
+}
+
+/* Returns chunk 'k', allocating and installing it if needed. Chunks are
+ * installed in order - a thread that holds chunk 'k' knows that every lower
+ * chunk is installed too.
+ * ERRORS: GC_ERR_ALLOC_FAIL */
+static void* _cvec_chunk(GCConcVector vector, size_t k, gc_status* out_status)
+{
+    void* chunk = atomic_load_explicit(&vector->_chunks[k],
+            memory_order_acquire);
+    if(chunk != NULL)
+    {
+        GC_RETURN(chunk, out_status, GC_SUCCESS);
+    }
+
+    gc_status _status;
+
+    size_t i;
+    for(i = 0; i <= k; i++)
+    {
+        chunk = atomic_load_explicit(&vector->_chunks[i],
+                memory_order_acquire);
+        if(chunk != NULL) continue;
+
+        chunk = _cvec_install(vector, i, &_status);
+
+        switch(_status)
+        {
+            case GC_SUCCESS:
+                break;
+            case GC_ERR_ALLOC_FAIL:
+                GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+            default:
+                GC_RETURN(NULL, out_status, GC_ERR_UNHANDLED);
+        }
+    }
+
+    GC_RETURN(chunk, out_status, GC_SUCCESS);
+}
+
+/* Lowers the limit to 'slot', unless it is already lower. */
+static void _cvec_fail(GCConcVector vector, size_t slot)
+{
+    size_t limit = atomic_load(&vector->_limit);
+
+    while((slot < limit) &&
+            !atomic_compare_exchange_weak(&vector->_limit, &limit, slot));
+}
+
+/* -------------------------------------------------------------------------- */
+
+GCConcVector _gc_cvec_create(size_t first_chunk_cap, size_t el_size,
+        gc_status* out_status)
+{
+    struct GCAllocator allocator = gc_allocator_default();
+
+    return _gc_cvec_create_with(first_chunk_cap, el_size, &allocator,
+            out_status);
+}
+
+GCConcVector _gc_cvec_create_with(size_t first_chunk_cap, size_t el_size,
+        const struct GCAllocator* allocator, gc_status* out_status)
+{
+    if((first_chunk_cap == 0) || (el_size == 0) || (allocator == NULL) ||
+            (first_chunk_cap > ((size_t)1 << (CVEC_BITS - 2))))
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    GCConcVector vec = (GCConcVector)gc_allocator_alloc(allocator,
+            sizeof(struct GCConcVector));
+    if(vec == NULL)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    atomic_init(&vec->_reserved, 0);
+    atomic_init(&vec->_size, 0);
+    atomic_init(&vec->_limit, SIZE_MAX);
+    vec->_el_size = el_size;
+    vec->_base_shift = (first_chunk_cap == 1) ? 0 :
+        _cvec_msb(first_chunk_cap - 1) + 1;
+    vec->_allocator = *allocator;
+
+    size_t i;
+    for(i = 0; i < CVEC_BITS; i++)
+        atomic_init(&vec->_chunks[i], NULL);
+
+    GC_RETURN(vec, out_status, GC_SUCCESS);
+}
+
+void gc_cvec_destroy(GCConcVector vector, gc_status* out_status)
+{
+    if(vector == NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    struct GCAllocator allocator = vector->_allocator;
+
+    size_t i;
+    for(i = 0; i < CVEC_BITS; i++)
+    {
+        void* chunk = atomic_load_explicit(&vector->_chunks[i],
+                memory_order_relaxed);
+
+        if(chunk != NULL)
+            gc_allocator_free(&allocator, chunk, _cvec_chunk_size(vector, i));
+    }
+
+    gc_allocator_free(&allocator, vector, sizeof(struct GCConcVector));
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+size_t gc_cvec_size(const GCConcVector vector)
+{
+    return (vector != NULL) ?
+        atomic_load_explicit(&vector->_size, memory_order_acquire) : 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void* _gc_cvec_at(const GCConcVector vector, size_t pos,
+        gc_status* out_status)
+{
+    if(vector == NULL)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+    if(pos >= atomic_load_explicit(&vector->_size, memory_order_acquire))
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_OUT_OF_BOUNDS);
+    }
+
+    size_t i = pos + ((size_t)1 << vector->_base_shift);
+    size_t msb = _cvec_msb(i);
+
+    // the chunk was installed before the element was published
+    char* chunk = atomic_load_explicit(
+            &vector->_chunks[msb - vector->_base_shift], memory_order_relaxed);
+
+    GC_RETURN(chunk + ((i - ((size_t)1 << msb)) * vector->_el_size),
+            out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void _gc_cvec_push_back(GCConcVector vector, const void* data,
+        gc_status* out_status)
+{
+    if((vector == NULL) || (data == NULL))
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    size_t slot = atomic_fetch_add_explicit(&vector->_reserved, 1,
+            memory_order_relaxed);
+
+    if(slot >= atomic_load_explicit(&vector->_limit, memory_order_acquire))
+    {
+        GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    size_t i = slot + ((size_t)1 << vector->_base_shift);
+    size_t msb = _cvec_msb(i);
+    size_t k = msb - vector->_base_shift;
+    size_t offset = i - ((size_t)1 << msb);
+
+    gc_status _status;
+    char* chunk = _cvec_chunk(vector, k, &_status);
+
+    switch(_status)
+    {
+        case GC_SUCCESS:
+            break;
+        case GC_ERR_ALLOC_FAIL:
+            _cvec_fail(vector, slot);
+            break;
+        default:
+            _cvec_fail(vector, slot);
+            GC_VRETURN(out_status, GC_ERR_UNHANDLED);
+    }
+
+    /* The limit is lowered before the chunk is checked again, and later
+     * slots check the limit after they are marked ready(all sequentially
+     * consistent). If a later slot missed the lowered limit, its chunk - and
+     * so this one too - is installed by now, and this slot is still written.
+     * Otherwise, the later slot reports the failure itself. */
+    if(chunk == NULL)
+    {
+        chunk = atomic_load(&vector->_chunks[k]);
+        if(chunk == NULL)
+        {
+            GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+        }
+    }
+
+    memcpy(chunk + (offset * vector->_el_size), data, vector->_el_size);
+    atomic_store(_cvec_ready(vector, chunk, k, offset), 1);
+
+    /* Publish - advance the size over every written slot. If an earlier slot
+     * is not written yet, its writer will advance the size past this one
+     * (the ready flags and the size are sequentially consistent, so one of
+     * the two writers always sees the other's flag). */
+    size_t size = atomic_load(&vector->_size);
+    while(_cvec_is_ready(vector, size))
+    {
+        if(atomic_compare_exchange_weak(&vector->_size, &size, size + 1))
+            size++;
+    }
+
+    /* An earlier slot that failed is never written, so this one is never
+     * published. A limit equal to 'slot' was set by this push_back itself. */
+    if(slot > atomic_load(&vector->_limit))
+    {
+        GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void gc_cvec_reserve(GCConcVector vector, size_t capacity,
+        gc_status* out_status)
+{
+    if(vector == NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    size_t k = 0;
+    size_t total = 0;
+    gc_status _status;
+    while(total < capacity)
+    {
+        _cvec_chunk(vector, k, &_status);
+
+        switch(_status)
+        {
+            case GC_SUCCESS:
+                break;
+            case GC_ERR_ALLOC_FAIL:
+                GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+            default:
+                GC_VRETURN(out_status, GC_ERR_UNHANDLED);
+        }
+
+        total += (size_t)1 << (vector->_base_shift + k);
+        k++;
+    }
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
@@ -0,0 +1,333 @@
+#include "ds/gc_seg_vector.h"
+#include "_gc_shared.h"
+#include "ds/gc_array.h"
+#include <stdint.h>
+#include <string.h>
+
+/* Initial capacity of the chunk directory. The directory doubles when it
+ * fills up - only the chunk pointers are copied then, never the elements. */
+#define SEGVEC_INIT_DIR_CAP 8
+
+/* Number of bits inside size_t. */
+#define SEGVEC_BITS (sizeof(size_t) * 8)
+
+struct GCSegVector
+{
+    /* size - the vector currently has this many elements */
+    size_t _size;
+
+    /* capacity - sum of capacities of all allocated chunks */
+    size_t _capacity;
+
+    /* el_size - size of single element(bytes) */
+    size_t _el_size;
+
+    /* base_shift - log2 of the first chunk's capacity. Chunk 'k' holds
+     * (1 << (base_shift + k)) elements. */
+    size_t _base_shift;
+
+    /* chunks - the chunk directory, a GCArray of chunk pointers. Chunks are
+     * never moved or freed before the vector is destroyed. */
+    _GCArray _chunks;
+
+    /* allocator - every allocation made by the vector(including the struct
+     * itself) goes through this allocator */
+    struct GCAllocator _allocator;
+};
+
+/* -------------------------------------------------------------------------- */
+
+/* Index of the highest set bit of 'x'. Assumes 'x' > 0. */
+static inline size_t _segvec_msb(size_t x)
+{
+    return (SEGVEC_BITS - 1) - __builtin_clzll((unsigned long long)x);
+}
+
+/* Capacity of chunk 'k'. */
+static inline size_t _segvec_chunk_cap(const GCSegVector vector, size_t k)
+{
+    return (size_t)1 << (vector->_base_shift + k);
+}
+
+/* Address of element at 'pos'. Element 'pos' is the element
+ * ('pos' + first_chunk_cap) of a vector whose chunks would start at
+ * capacity 1 - its highest set bit picks the chunk, the remaining bits are
+ * the offset inside it. Assumes 'pos' < 'vector->_capacity'. */
+static inline void* _segvec_addr(const GCSegVector vector, size_t pos)
+{
+    size_t i = pos + ((size_t)1 << vector->_base_shift);
+    size_t msb = _segvec_msb(i);
+
+    char* chunk = *(char**)_gc_arr_at_unchecked(vector->_chunks,
+            msb - vector->_base_shift);
+
+    return chunk + ((i - ((size_t)1 << msb)) * vector->_el_size);
+}
+
+/* Allocates the next chunk and appends it to the directory.
+ * ERRORS: GC_ERR_ALLOC_FAIL */
+static void _segvec_add_chunk(GCSegVector vector, gc_status* out_status)
+{
+    size_t k = gc_arr_size_unchecked(vector->_chunks);
+
+    if((vector->_base_shift + k) >= (SEGVEC_BITS - 1))
+    {
+        GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    size_t cap = _segvec_chunk_cap(vector, k);
+
+    if((cap > (SIZE_MAX / vector->_el_size)) ||
+            (vector->_capacity > (SIZE_MAX - cap)))
+    {
+        GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    gc_status _status;
+    if(k == gc_arr_capacity(vector->_chunks))
+    {
+        gc_arr_reserve(vector->_chunks, k * 2, &_status);
+        if(_status != GC_SUCCESS)
+        {
+            GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+        }
+    }
+
+    void* chunk = gc_allocator_alloc(&vector->_allocator,
+            cap * vector->_el_size);
+    if(chunk == NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    _gc_arr_push_back_unchecked(vector->_chunks, &chunk);
+    vector->_capacity += cap;
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+GCSegVector _gc_segvec_create(size_t first_chunk_cap, size_t el_size,
+        gc_status* out_status)
+{
+    struct GCAllocator allocator = gc_allocator_default();
+
+    return _gc_segvec_create_with(first_chunk_cap, el_size, &allocator,
+            out_status);
+}
+
+GCSegVector _gc_segvec_create_with(size_t first_chunk_cap, size_t el_size,
+        const struct GCAllocator* allocator, gc_status* out_status)
+{
+    if((first_chunk_cap == 0) || (el_size == 0) || (allocator == NULL) ||
+            (first_chunk_cap > ((size_t)1 << (SEGVEC_BITS - 2))))
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    GCSegVector vec = (GCSegVector)gc_allocator_alloc(allocator,
+            sizeof(struct GCSegVector));
+    if(vec == NULL)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    gc_status _status;
+    vec->_chunks = _gc_arr_create_with(SEGVEC_INIT_DIR_CAP, sizeof(void*),
+            allocator, &_status);
+
+    switch(_status)
+    {
+        case GC_SUCCESS:
+            break;
+        case GC_ERR_ALLOC_FAIL:
+            gc_allocator_free(allocator, vec, sizeof(struct GCSegVector));
+            GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+        default:
+            gc_allocator_free(allocator, vec, sizeof(struct GCSegVector));
+            GC_RETURN(NULL, out_status, GC_ERR_UNHANDLED);
+    }
+
+    vec->_size = 0;
+    vec->_capacity = 0;
+    vec->_el_size = el_size;
+    vec->_base_shift = (first_chunk_cap == 1) ? 0 :
+        _segvec_msb(first_chunk_cap - 1) + 1;
+    vec->_allocator = *allocator;
+
+    GC_RETURN(vec, out_status, GC_SUCCESS);
+}
+
+void gc_segvec_destroy(GCSegVector vector, gc_status* out_status)
+{
+    if(vector == NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    struct GCAllocator allocator = vector->_allocator;
+
+    size_t i;
+    size_t count = gc_arr_size_unchecked(vector->_chunks);
+    for(i = 0; i < count; i++)
+    {
+        void* chunk = *(void**)_gc_arr_at_unchecked(vector->_chunks, i);
+
+        gc_allocator_free(&allocator, chunk,
+                _segvec_chunk_cap(vector, i) * vector->_el_size);
+    }
+
+    gc_arr_destroy(vector->_chunks, NULL);
+
+    gc_allocator_free(&allocator, vector, sizeof(struct GCSegVector));
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+size_t gc_segvec_size(const GCSegVector vector)
+{
+    return (vector != NULL) ? vector->_size : 0;
+}
+
+size_t gc_segvec_capacity(const GCSegVector vector)
+{
+    return (vector != NULL) ? vector->_capacity : 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void* _gc_segvec_at(const GCSegVector vector, size_t pos,
+        gc_status* out_status)
+{
+    if(vector == NULL)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+    if(pos >= vector->_size)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_OUT_OF_BOUNDS);
+    }
+
+    GC_RETURN(_segvec_addr(vector, pos), out_status, GC_SUCCESS);
+}
+
+void _gc_segvec_set(GCSegVector vector, const void* data, size_t pos,
+        gc_status* out_status)
+{
+    if((vector == NULL) || (data == NULL))
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+    if(pos >= vector->_size)
+    {
+        GC_VRETURN(out_status, GC_ERR_OUT_OF_BOUNDS);
+    }
+
+    memcpy(_segvec_addr(vector, pos), data, vector->_el_size);
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void _gc_segvec_push_back(GCSegVector vector, const void* data,
+        gc_status* out_status)
+{
+    if(data == NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    gc_status _status;
+    void* addr = gc_segvec_emplace_back(vector, &_status);
+
+    switch(_status)
+    {
+        case GC_SUCCESS:
+            memcpy(addr, data, vector->_el_size);
+            GC_VRETURN(out_status, GC_SUCCESS);
+        case GC_ERR_INVALID_ARG:
+            GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+        case GC_ERR_ALLOC_FAIL:
+            GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+        default:
+            GC_VRETURN(out_status, GC_ERR_UNHANDLED);
+    }
+}
+
+void* gc_segvec_emplace_back(GCSegVector vector, gc_status* out_status)
+{
+    if(vector == NULL)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    if(vector->_size == vector->_capacity)
+    {
+        gc_status _status;
+        _segvec_add_chunk(vector, &_status);
+
+        switch(_status)
+        {
+            case GC_SUCCESS:
+                break;
+            case GC_ERR_ALLOC_FAIL:
+                GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+            default:
+                GC_RETURN(NULL, out_status, GC_ERR_UNHANDLED);
+        }
+    }
+
+    void* addr = _segvec_addr(vector, vector->_size);
+    vector->_size++;
+
+    GC_RETURN(addr, out_status, GC_SUCCESS);
+}
+
+void gc_segvec_pop_back(GCSegVector vector, gc_status* out_status)
+{
+    if(vector == NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+    if(vector->_size == 0)
+    {
+        GC_VRETURN(out_status, GC_ERR_VECTOR_EMPTY);
+    }
+
+    vector->_size--;
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void gc_segvec_reserve(GCSegVector vector, size_t capacity,
+        gc_status* out_status)
+{
+    if(vector == NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    gc_status _status;
+    while(vector->_capacity < capacity)
+    {
+        _segvec_add_chunk(vector, &_status);
+
+        switch(_status)
+        {
+            case GC_SUCCESS:
+                break;
+            case GC_ERR_ALLOC_FAIL:
+                GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+            default:
+                GC_VRETURN(out_status, GC_ERR_UNHANDLED);
+        }
+    }
+
+    GC_VRETURN(out_status, GC_SUCCESS);
+}
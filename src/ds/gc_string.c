@@ -15,6 +15,7 @@ struct _GCString
     char* data;
     size_t len;
     size_t capacity;
+    struct GCAllocator allocator;
 };
 
 static void _expand_string(GCString str, size_t new_capacity,
@@ -45,16 +46,30 @@ GCString gc_str_create(const char* content, gc_status* out_status)
 GCString gc_str_create_(const char* content, size_t len,
         gc_status* out_status)
 {
-    GCString str = (GCString)malloc(sizeof(struct _GCString));
+    struct GCAllocator allocator = gc_allocator_default();
+
+    return gc_str_create_with(content, len, &allocator, out_status);
+}
+
+GCString gc_str_create_with(const char* content, size_t len,
+        const struct GCAllocator* allocator, gc_status* out_status)
+{
+    if(allocator == NULL)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    GCString str = (GCString)gc_allocator_alloc(allocator,
+            sizeof(struct _GCString));
     if(str == NULL)
     {
         GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
     }
 
-    void* str_data = malloc(len + 1);
+    void* str_data = gc_allocator_alloc(allocator, len + 1);
     if(str_data == NULL)
     {
-        free(str);
+        gc_allocator_free(allocator, str, sizeof(struct _GCString));
         GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
     }
 
@@ -64,6 +79,7 @@ GCString gc_str_create_(const char* content, size_t len,
     str->data = str_data;
     str->len = len;
     str->capacity = len;
+    str->allocator = *allocator;
 
     str->data[len] = '\0';
 
@@ -82,10 +98,13 @@ void gc_str_destroy(GCString str, gc_status* out_status)
         GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
     }
 
-    if(str->data != NULL) free(str->data);
+    struct GCAllocator allocator = str->allocator;
+
+    if(str->data != NULL)
+        gc_allocator_free(&allocator, str->data, str->capacity + 1);
     str->capacity = 0;
     str->len = 0;
-    free(str);
+    gc_allocator_free(&allocator, str, sizeof(struct _GCString));
 
     GC_VRETURN(out_status, GC_SUCCESS);
 }
@@ -480,9 +499,11 @@ struct GCStringFindAllObject gc_str_find_all(GCStringView haystack,
         GC_RETURN(_STR_FIND_ALL_OBJ_EMPTY, out_status, GC_SUCCESS);
     }
 
-    // We don't know how many matches we're going to get - we use a vector
+    // We don't know how many matches we're going to get - we use a vector.
+    // Usually there are only a few, so they are kept inline.
 
-    GCVVector vec = gc_vec_create_val(10, struct GCStringFindObject, &_status);
+    GCVVector vec = gc_vec_create_val_small(8, struct GCStringFindObject,
+            &_status);
     if(_status == GC_ERR_ALLOC_FAIL)
     {
         GC_RETURN(_STR_FIND_ALL_OBJ_EMPTY, out_status, GC_ERR_ALLOC_FAIL);
@@ -677,7 +698,8 @@ void gc_str_reserve(GCString str, size_t capacity, gc_status* out_status)
         GC_VRETURN(out_status, GC_SUCCESS);
     }
 
-    void* new_data = realloc(str->data, capacity + 1);
+    void* new_data = gc_allocator_realloc(&str->allocator, str->data,
+            str->capacity + 1, capacity + 1);
 
     if(new_data == NULL)
     {
@@ -748,7 +770,8 @@ static void _expand_string(GCString str, size_t new_capacity,
         GC_VRETURN(out_status, GC_SUCCESS);
     }
 
-    void* new_data = realloc(str->data, new_capacity + 1);
+    void* new_data = gc_allocator_realloc(&str->allocator, str->data,
+            str->capacity + 1, new_capacity + 1);
 
     if(new_data != NULL)
     {
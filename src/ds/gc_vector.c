@@ -2,38 +2,79 @@
 #include "_gc_shared.h"
 #include "ds/_gc_vector.h"
 #include "ds/gc_array.h"
+#include <stdint.h>
 
 #define EXPAND_FACTOR 2.0
 
 _GCVector _gc_vec_create(size_t capacity, size_t el_size, gc_status* out_status)
 {
-    if((capacity == 0) || (el_size == 0))
+    struct GCAllocator allocator = gc_allocator_default();
+
+    return _gc_vec_create_with(capacity, el_size, &allocator, out_status);
+}
+
+_GCVector _gc_vec_create_with(size_t capacity, size_t el_size,
+        const struct GCAllocator* allocator, gc_status* out_status)
+{
+    if((capacity == 0) || (el_size == 0) || (allocator == NULL))
     {
         GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
     }
 
-    _GCVector vec = (_GCVector)malloc(sizeof(struct __GCVector));
+    _GCVector vec = (_GCVector)gc_allocator_alloc(allocator,
+            sizeof(struct __GCVector));
     if(vec == NULL)
     {
         GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
     }
 
     gc_status _status;
-    __gc_vec_init(vec, capacity, el_size, &_status);
+    __gc_vec_init(vec, capacity, el_size, allocator, &_status);
 
     switch(_status)
     {
         case GC_SUCCESS:
             GC_RETURN(vec, out_status, GC_SUCCESS);
         case GC_ERR_ALLOC_FAIL:
-            free(vec);
+            gc_allocator_free(allocator, vec, sizeof(struct __GCVector));
             GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
         default:
-            free(vec);
+            gc_allocator_free(allocator, vec, sizeof(struct __GCVector));
             GC_RETURN(NULL, out_status, GC_ERR_UNHANDLED);
     }
 }
 
+_GCVector _gc_vec_create_small(size_t inline_cap, size_t el_size,
+        gc_status* out_status)
+{
+    struct GCAllocator allocator = gc_allocator_default();
+
+    return _gc_vec_create_small_with(inline_cap, el_size, &allocator,
+            out_status);
+}
+
+_GCVector _gc_vec_create_small_with(size_t inline_cap, size_t el_size,
+        const struct GCAllocator* allocator, gc_status* out_status)
+{
+    if((inline_cap == 0) || (el_size == 0) || (allocator == NULL) ||
+            (inline_cap > (SIZE_MAX - __GC_ARR_INLINE_OFFSET) / el_size))
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    // the struct and its inline storage are a single allocation
+    _GCVector vec = (_GCVector)gc_allocator_alloc(allocator,
+            __GC_ARR_INLINE_OFFSET + (inline_cap * el_size));
+    if(vec == NULL)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    __gc_arr_init_inline(&vec->_base, inline_cap, el_size, allocator);
+
+    GC_RETURN(vec, out_status, GC_SUCCESS);
+}
+
 void gc_vec_destroy(_GCVector vector, gc_status* out_status)
 {
     if(vector == NULL)
@@ -41,9 +82,14 @@ void gc_vec_destroy(_GCVector vector, gc_status* out_status)
         GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
     }
 
+    struct GCAllocator allocator = vector->_base._allocator;
+    size_t struct_size = __gc_arr_struct_size(&vector->_base);
+
     __gc_vec_destroy(vector);
     
-    free(vector);
+    gc_allocator_free(&allocator, vector, struct_size);
+
+    GC_VRETURN(out_status, GC_SUCCESS);
 }
 
 void* _gc_vec_at(const _GCVector vector, size_t pos, gc_status* out_status)
@@ -172,6 +218,144 @@ void _gc_vec_push_back(_GCVector vector, const void* data, gc_status* out_status
     }
 }
 
+/* Grows the vector, once, so that it can store at least 'min_cap' elements. */
+static void __vec_grow(_GCVector vector, size_t min_cap, gc_status* out_status)
+{
+    _GCArray _vector = (_GCArray)vector;
+
+    size_t cap = gc_arr_capacity(_vector) * EXPAND_FACTOR;
+    if(cap < min_cap) cap = min_cap;
+
+    gc_status _status;
+    gc_arr_reserve(_vector, cap, &_status);
+
+    switch(_status)
+    {
+        case GC_SUCCESS:
+            GC_VRETURN(out_status, GC_SUCCESS);
+        case GC_ERR_ALLOC_FAIL:
+            GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+        default:
+            GC_VRETURN(out_status, GC_ERR_UNHANDLED);
+    }
+}
+
+void gc_vec_insert_n(_GCVector vector, const void* data_arr, size_t count,
+        size_t pos, gc_status* out_status)
+{
+    _GCArray _vector = (_GCArray)vector;
+
+    gc_status _status;
+    gc_arr_insert_n(_vector, data_arr, count, pos, &_status);
+
+    switch(_status)
+    {
+        case GC_SUCCESS:
+            GC_VRETURN(out_status, GC_SUCCESS);
+        case GC_ERR_OUT_OF_BOUNDS:
+            GC_VRETURN(out_status, GC_ERR_OUT_OF_BOUNDS);
+        case GC_ERR_INVALID_ARG:
+            GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+        case GC_ERR_ARRAY_NO_CAP:
+            break;
+        default:
+            GC_VRETURN(out_status, GC_ERR_UNHANDLED);
+    }
+
+    size_t size = gc_arr_size(_vector);
+    if(count > SIZE_MAX - size)
+    {
+        GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+    }
+
+    __vec_grow(vector, size + count, &_status);
+
+    switch(_status)
+    {
+        case GC_SUCCESS:
+            break;
+        case GC_ERR_ALLOC_FAIL:
+            GC_VRETURN(out_status, GC_ERR_ALLOC_FAIL);
+        default:
+            GC_VRETURN(out_status, GC_ERR_UNHANDLED);
+    }
+
+    gc_arr_insert_n(_vector, data_arr, count, pos, &_status);
+
+    switch(_status)
+    {
+        case GC_SUCCESS:
+            GC_VRETURN(out_status, GC_SUCCESS);
+        default:
+            GC_VRETURN(out_status, GC_ERR_UNHANDLED);
+    }
+}
+
+void gc_vec_append_n(_GCVector vector, const void* data_arr, size_t count,
+        gc_status* out_status)
+{
+    if(vector == NULL)
+    {
+        GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+    }
+
+    gc_vec_insert_n(vector, data_arr, count, gc_arr_size((_GCArray)vector),
+            out_status);
+}
+
+void* gc_vec_emplace_at(_GCVector vector, size_t pos, gc_status* out_status)
+{
+    _GCArray _vector = (_GCArray)vector;
+
+    gc_status _status;
+    void* slot = gc_arr_emplace_at(_vector, pos, &_status);
+
+    switch(_status)
+    {
+        case GC_SUCCESS:
+            GC_RETURN(slot, out_status, GC_SUCCESS);
+        case GC_ERR_OUT_OF_BOUNDS:
+            GC_RETURN(NULL, out_status, GC_ERR_OUT_OF_BOUNDS);
+        case GC_ERR_INVALID_ARG:
+            GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+        case GC_ERR_ARRAY_NO_CAP:
+            break;
+    }
+
+    __vec_expand(vector, &_status);
+
+    switch(_status)
+    {
+        case GC_SUCCESS:
+            break;
+        case GC_ERR_ALLOC_FAIL:
+            GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
+        default:
+            GC_RETURN(NULL, out_status, GC_ERR_UNHANDLED);
+    }
+
+    slot = gc_arr_emplace_at(_vector, pos, &_status);
+
+    switch(_status)
+    {
+        case GC_SUCCESS:
+            GC_RETURN(slot, out_status, GC_SUCCESS);
+        default:
+            GC_RETURN(NULL, out_status, GC_ERR_UNHANDLED);
+    }
+}
+
+void* gc_vec_emplace_back(_GCVector vector, gc_status* out_status)
+{
+    if(vector == NULL)
+    {
+        GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
+    }
+
+    return gc_vec_emplace_at(vector, gc_arr_size((_GCArray)vector),
+            out_status);
+}
+
 void gc_vec_remove(_GCVector vector, size_t pos, gc_status* out_status)
 {
     gc_status _status;
@@ -190,6 +374,43 @@ void gc_vec_remove(_GCVector vector, size_t pos, gc_status* out_status)
     }
 }
 
+void gc_vec_remove_range(_GCVector vector, size_t start_pos, size_t end_pos,
+        gc_status* out_status)
+{
+    gc_status _status;
+    gc_arr_remove_range((_GCArray)vector, start_pos, end_pos, &_status);
+
+    switch(_status)
+    {
+        case GC_SUCCESS:
+            GC_VRETURN(out_status, GC_SUCCESS);
+        case GC_ERR_INVALID_ARG:
+            GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+        case GC_ERR_OUT_OF_BOUNDS:
+            GC_VRETURN(out_status, GC_ERR_OUT_OF_BOUNDS);
+        default:
+            GC_VRETURN(out_status, GC_ERR_UNHANDLED);
+    }
+}
+
+void gc_vec_swap_remove(_GCVector vector, size_t pos, gc_status* out_status)
+{
+    gc_status _status;
+    gc_arr_swap_remove((_GCArray)vector, pos, &_status);
+
+    switch(_status)
+    {
+        case GC_SUCCESS:
+            GC_VRETURN(out_status, GC_SUCCESS);
+        case GC_ERR_INVALID_ARG:
+            GC_VRETURN(out_status, GC_ERR_INVALID_ARG);
+        case GC_ERR_OUT_OF_BOUNDS:
+            GC_VRETURN(out_status, GC_ERR_OUT_OF_BOUNDS);
+        default:
+            GC_VRETURN(out_status, GC_ERR_UNHANDLED);
+    }
+}
+
 void gc_vec_pop_back(_GCVector vector, gc_status* out_status)
 {
     gc_status _status;
@@ -6,20 +6,26 @@
 #include <assert.h>
 #include <stdlib.h>
 
+#define EVENT_INLINE_SUBSCRIBERS 4
+
 struct _GCEvent
 {
     GCEventParticipant source;
     GCPVector subscribers;
+    struct GCAllocator allocator;
 };
 
 /* Function assumes correct arguments */
 static void __event_init(GCEvent event, GCEventParticipant source,
-        gc_status* out_status)
+        const struct GCAllocator* allocator, gc_status* out_status)
 {
     event->source = source;
+    event->allocator = *allocator;
 
     gc_status _status;
-    event->subscribers = gc_vec_create_val(10, struct GCEventSubscription, &_status);
+    // most events have only a few subscribers - keep them inline
+    event->subscribers = gc_vec_create_val_small_with(EVENT_INLINE_SUBSCRIBERS,
+            struct GCEventSubscription, allocator, &_status);
 
     switch(_status)
     {
@@ -36,12 +42,21 @@ static void __event_init(GCEvent event, GCEventParticipant source,
 
 GCEvent gc_event_create(GCEventParticipant source, gc_status* out_status)
 {
-    GCEvent event = (GCEvent)malloc(sizeof(struct _GCEvent));
+    struct GCAllocator allocator = gc_allocator_default();
+
+    return gc_event_create_with(source, &allocator, out_status);
+}
 
-    if(source == NULL)
+GCEvent gc_event_create_with(GCEventParticipant source,
+        const struct GCAllocator* allocator, gc_status* out_status)
+{
+    if((source == NULL) || (allocator == NULL))
     {
         GC_RETURN(NULL, out_status, GC_ERR_INVALID_ARG);
     }
+
+    GCEvent event = (GCEvent)gc_allocator_alloc(allocator,
+            sizeof(struct _GCEvent));
     
     if(event == NULL)
     {
@@ -49,17 +64,17 @@ GCEvent gc_event_create(GCEventParticipant source, gc_status* out_status)
     }
 
     gc_status _status;
-    __event_init(event, source, &_status);
+    __event_init(event, source, allocator, &_status);
 
     switch(_status)
     {
         case GC_SUCCESS:
             GC_RETURN(event, out_status, GC_SUCCESS);
         case GC_ERR_ALLOC_FAIL:
-            free(event);
+            gc_allocator_free(allocator, event, sizeof(struct _GCEvent));
             GC_RETURN(NULL, out_status, GC_ERR_ALLOC_FAIL);
         default:
-            free(event);
+            gc_allocator_free(allocator, event, sizeof(struct _GCEvent));
             GC_RETURN(NULL, out_status, GC_ERR_UNHANDLED);
     }
 }
@@ -76,7 +91,8 @@ void gc_event_destroy(GCEvent event, gc_status* out_status)
 
     event->source = NULL;
 
-    free(event);
+    struct GCAllocator allocator = event->allocator;
+    gc_allocator_free(&allocator, event, sizeof(struct _GCEvent));
 
     GC_VRETURN(out_status, GC_SUCCESS);
 }
@@ -129,7 +145,7 @@ void gc_event_unsubscribe(GCEvent event, GCEventParticipant subscriber,
         if(curr_sub.subscriber == subscriber)
         {
             gc_status _status;
-            gc_vec_remove(subs, i, &_status);
+            gc_vec_swap_remove(subs, i, &_status);
 
             switch(_status)
             {
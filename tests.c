@@ -1,3 +1,4 @@
+#include "ds/gc_array.h"
 #include "ds/gc_string.h"
 #include "event/gc_event.h"
 #include <fcntl.h>
@@ -28,8 +29,38 @@ void sub_ehandler2(GCEventParticipant subscriber,
 
 }
 
+/* Fitting an empty heap array and growing it again must keep the data on the
+ * heap. */
+void test_arr_fit_empty()
+{
+    gc_status _status;
+
+    _GCArray arr = _gc_arr_create(4, sizeof(int), &_status);
+    assert(_status == GC_SUCCESS);
+
+    gc_arr_fit(arr, &_status);
+    assert(_status == GC_SUCCESS);
+
+    gc_arr_reserve(arr, 8, &_status);
+    assert(_status == GC_SUCCESS);
+    assert(gc_arr_capacity(arr) >= 8);
+
+    int i;
+    for(i = 0; i < 8; i++)
+    {
+        _gc_arr_push_back(arr, &i, &_status);
+        assert(_status == GC_SUCCESS);
+    }
+    assert(*(int*)_gc_arr_at(arr, 7, &_status) == 7);
+
+    gc_arr_destroy(arr, &_status);
+    assert(_status == GC_SUCCESS);
+}
+
 int main(int argc, char *argv[])
 {
+    test_arr_fit_empty();
+
 
     GCStringSt str1 = gc_strst("Novak123|Emilija,Djordjevic,Emili|4456");
 